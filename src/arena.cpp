@@ -0,0 +1,133 @@
+#include "arena.h"
+#include <new>
+#include <algorithm>
+
+thread_local Arena::Local Arena::_local;
+Arena * Arena::_current = 0;
+std::atomic<uint64_t> Arena::_lastid(0);
+
+Arena::Arena()
+ : _id(++_lastid), _shcur(0), _shend(0), _exited(0)
+{
+}
+
+Arena::~Arena()
+{
+  for ( void * chunk: _chunks )
+    ::operator delete(chunk);
+  if ( _local.id == _id ) _local = Local();
+}
+
+Arena::Local::~Local()
+{
+  if ( id != 0 && _current != 0 && _current->_id == id )
+    _current->_exited += live;
+}
+
+Arena::Local * Arena::local()
+{
+  Local& loc = _local;
+  if ( loc.id != _id ) {
+    // the state belongs to another arena, don't take it from the arena of the current scope
+    if ( _current != 0 && _current != this && loc.id == _current->_id ) return 0;
+    loc = Local();
+    loc.id = _id;
+  }
+  return &loc;
+}
+
+void Arena::newchunk(char *& cur, char *& end)
+{
+  char * chunk = static_cast<char *>(::operator new(chunksize));
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _chunks.push_back(chunk);
+  }
+  cur = chunk;
+  end = chunk + chunksize;
+}
+
+void * Arena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+  if ( bytes > maxblock || alignment > granule )
+    return ::operator new(bytes, std::align_val_t(alignment));
+  std::size_t size = std::max<std::size_t>((bytes+granule-1)/granule,1)*granule;
+  Local * loc = local();
+  if ( !loc ) {
+    // arena of another scope: cut from the shared chunk
+    std::lock_guard<std::mutex> lock(_shmtx);
+    ++_exited;
+    if ( _shcur + size > _shend ) newchunk(_shcur,_shend);
+    void * p = _shcur;
+    _shcur += size;
+    return p;
+  }
+  ++loc->live;
+  void *& head = loc->free[size/granule];
+  void * p = head;
+  if ( p ) {
+    head = *static_cast<void **>(p);
+    return p;
+  }
+  if ( loc->cur + size > loc->end ) newchunk(loc->cur,loc->end);
+  p = loc->cur;
+  loc->cur += size;
+  return p;
+}
+
+void Arena::do_deallocate(void * p, std::size_t bytes, std::size_t alignment)
+{
+  if ( bytes > maxblock || alignment > granule ) {
+    ::operator delete(p, bytes, std::align_val_t(alignment));
+    return;
+  }
+  std::size_t size = std::max<std::size_t>((bytes+granule-1)/granule,1)*granule;
+  Local * loc = local();
+  if ( !loc ) {
+    // arena of another scope: the block is lost until the release
+    --_exited;
+    return;
+  }
+  --loc->live;
+  void *& head = loc->free[size/granule];
+  *static_cast<void **>(p) = head;
+  head = p;
+}
+
+long int Arena::live() const
+{
+  long int nlive = _exited;
+  if ( _local.id == _id ) nlive += _local.live;
+  return nlive;
+}
+
+bool Arena::release()
+{
+  if ( live() != 0 ) return false;
+  std::lock_guard<std::mutex> lock(_mtx);
+  for ( void * chunk: _chunks )
+    ::operator delete(chunk);
+  _chunks.clear();
+  _shcur = _shend = 0;
+  if ( _local.id == _id ) _local = Local();
+  return true;
+}
+
+Arena::Scope::Scope(bool use)
+ : _arena(0), _prev(0)
+{
+  if ( !use ) return;
+  _arena = new Arena();
+  _current = _arena;
+  _prev = std::pmr::set_default_resource(_arena);
+}
+
+Arena::Scope::~Scope()
+{
+  if ( !_arena ) return;
+  std::pmr::set_default_resource(_prev);
+  _current = 0;
+  if ( _arena->release() )
+    delete _arena;
+  // otherwise some objects still live in the arena, keep it
+}
@@ -0,0 +1,83 @@
+#ifndef Arena_H
+#define Arena_H
+
+#include <memory_resource>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstddef>
+#include <stdint.h>
+
+/*!
+    Implements a memory resource for all objects of one equation (nodes of Sets, Sums, ...)
+
+    Small blocks are cut from large chunks and recycled in thread-local free lists
+    (no locks on the hot path, blocks can be deallocated in another thread).
+    All chunks are freed at once when the arena is released.
+*/
+class Arena : public std::pmr::memory_resource {
+public:
+  Arena();
+  ~Arena();
+  //! number of blocks which have not been deallocated yet (all other threads have to be joined)
+  long int live() const;
+  //! free all chunks, only if no blocks are alive (returns false otherwise)
+  bool release();
+
+  /*!
+      Installs an arena as the default memory resource for the lifetime of the scope
+      (has to be created and destroyed in the main thread, only one scope at a time).
+      The arena is released at the end of the scope. If some objects outlive the scope,
+      the memory is kept.
+  */
+  class Scope {
+  public:
+    explicit Scope(bool use = true);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  private:
+    Arena * _arena;
+    std::pmr::memory_resource * _prev;
+  };
+
+private:
+  void * do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void * p, std::size_t bytes, std::size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+  { return this == &other; };
+  // block sizes are multiples of granule, larger blocks go to the upstream resource
+  static const std::size_t granule = 8, maxblock = 4096, nclasses = maxblock/granule+1;
+  static const std::size_t chunksize = 256*1024;
+  // state of the current thread
+  struct Local {
+    // id of the arena the state belongs to
+    uint64_t id = 0;
+    // free blocks for each size class (linked through their first word)
+    void * free[nclasses] = {};
+    // rest of the current chunk
+    char * cur = nullptr, * end = nullptr;
+    // allocated minus deallocated blocks in this thread
+    long int live = 0;
+    // hand the live count over to the arena
+    ~Local();
+  };
+  // state of the current thread for this arena (0 if the thread works for the arena of the current scope)
+  Local * local();
+  // new chunk [cur,end)
+  void newchunk(char *& cur, char *& end);
+  static thread_local Local _local;
+  // arena of the current scope (for the live counts of finished threads)
+  static Arena * _current;
+  static std::atomic<uint64_t> _lastid;
+  uint64_t _id;
+  std::mutex _mtx;
+  std::vector<void *> _chunks;
+  // shared chunk for threads working for the arena of another scope
+  std::mutex _shmtx;
+  char * _shcur, * _shend;
+  // live counts of finished threads
+  std::atomic<long int> _exited;
+};
+
+#endif
@@ -404,7 +404,8 @@ Matrix LEquation::do_sumterms(bool excopsonly )
         indxoperterm.clear();
       }
     } else if (InSet(lex, Lelem::Frac,Lelem::Num)) { // add prefactor
-      term *= handle_factor(lel);
+      // (the term is not reset in excopsonly mode, the prefactors would accumulate)
+      if (!excopsonly) term *= handle_factor(lel);
     } else if (lex == Lelem::Oper) { // handle Operator
       term *= handle_operator(lel,term,excopsonly);
       indxoperterm.push_back(i+1);
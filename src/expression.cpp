@@ -109,9 +109,7 @@ Expression::Expression()
     } else {
       // slottypes
       for ( std::size_t ii = ibra+1; ii < iket; ){
-        SlotTypes::iterator ist = _slottypes.begin();
-        ist = _slottypes.insert( ist, SlotType(ReadAndAdvance(ii,dt.first)) );
-        sts.push_back(&(*ist));
+        sts.push_back(add(SlotType(ReadAndAdvance(ii,dt.first))));
       }
     }
     Tensor tens(sts,name);
@@ -122,8 +120,10 @@ Expression::Expression()
 
 const SlotType* Expression::add(const SlotType& slottype)
 {
-  SlotTypes::iterator it = _slottypes.begin();
-  it = _slottypes.insert(it,slottype);
+  SlotType st(slottype);
+  // new slot types get the next index (an existing one keeps its index)
+  st._index = _slottypes.size();
+  SlotTypes::iterator it = _slottypes.insert(st).first;
   return &(*it);
 }
 
@@ -24,7 +24,7 @@ Factorizer::Factorizer(const std::vector<TermSum>& s)
         fact *= fac;
         Term term = ist->first;
         Diagram diag = Translators::term2diagram(term,fact,slotorbs,_expression);
-        if ( Input::iPars["prog"]["algo"] == 1 ) diag.binarize(_expression);
+        if ( Input::config.algo == 1 ) diag.binarize(_expression);
       }
     }
   }
@@ -32,36 +32,36 @@ Factorizer::Factorizer(const std::vector<TermSum>& s)
 
 SlotType Translators::orb2slot(const Orbital& orb)
 {
-  bool explspin = Input::iPars["prog"]["explspin"];
+  bool explspin = Input::config.explspin;
   switch (orb.type()) {
     case Orbital::Occ:
       if (explspin)
         if( orb.spin().type() == Spin::Up )
-          return SlotType(Input::iPars["fact"]["nocc"],SlotType::OccA);
+          return SlotType(Input::config.nocc,SlotType::OccA);
         else if( orb.spin().type() == Spin::Down )
-          return SlotType(Input::iPars["fact"]["nocc"],SlotType::OccB);
+          return SlotType(Input::config.nocc,SlotType::OccB);
         else
           error("What am i doing here?","Translators::orb2slot");
       else
-        return SlotType(Input::iPars["fact"]["nocc"],SlotType::Occ);
+        return SlotType(Input::config.nocc,SlotType::Occ);
       break;
     case Orbital::Virt:
       if (explspin)
         if( orb.spin().type() == Spin::Up ){
-          return SlotType(Input::iPars["fact"]["nvir"],SlotType::VirtA);}
+          return SlotType(Input::config.nvir,SlotType::VirtA);}
         else if( orb.spin().type() == Spin::Down ){ 
-          return SlotType(Input::iPars["fact"]["nvir"],SlotType::VirtB);}
+          return SlotType(Input::config.nvir,SlotType::VirtB);}
         else{
           error("What am i doing here?","Translators::orb2slot");}
       else
-        return SlotType(Input::iPars["fact"]["nvir"],SlotType::Virt);
+        return SlotType(Input::config.nvir,SlotType::Virt);
       break;
     case Orbital::Act:
-      return SlotType(Input::iPars["fact"]["nact"],SlotType::Act);
+      return SlotType(Input::config.nact,SlotType::Act);
     case Orbital::GenT:
     {
-      int ngen = Input::iPars["fact"]["nocc"]+Input::iPars["fact"]["nvir"];
-      if ( Input::iPars["prog"]["multiref"] > 0 ) ngen += Input::iPars["fact"]["nact"];
+      int ngen = Input::config.nocc+Input::config.nvir;
+      if ( Input::config.multiref > 0 ) ngen += Input::config.nact;
       return SlotType(ngen,SlotType::GenT);
     }
     default:
@@ -115,10 +115,10 @@ Diagram Translators::term2diagram(Term& term, Factor fact, const std::map< Orbit
 
   uint nbareops = 0;
   for (auto& m: term.get_mat()){
-    if ( Input::iPars["prog"]["algo"] == 1 ){//ITF code
+    if ( Input::config.algo == 1 ){//ITF code
       m.itforder();
     }
-    else if ( Input::iPars["prog"]["algo"] == 2 ){//ElemCo code
+    else if ( Input::config.algo == 2 ){//ElemCo code
       m.elemcoorder();
     }
     else
@@ -139,7 +139,7 @@ Diagram Translators::term2diagram(Term& term, Factor fact, const std::map< Orbit
     // stores info about performed permutations
     // e.g. kibj -> bkij slotorder = 2013
     slotorder = Slots();
-    if ( m.type() == Ops::Exc0 || m.type() == Ops::Deexc0 || m.type() == Ops::Exc || Input::iPars["prog"]["algo"] < 2 ){
+    if ( m.type() == Ops::Exc0 || m.type() == Ops::Deexc0 || m.type() == Ops::Exc || Input::config.algo < 2 ){
       Canonicalize(sts,slotorder,m._threeelectronint);
       // reorder positions according to the canonical order
       positions = positions.refarr(slotorder);
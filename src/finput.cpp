@@ -52,6 +52,7 @@ void Finput::InitInpars(std::string paramspath)
   else
     error(finp_file+": Bad input-parameters file!");
   finp.close();
+  Input::setconfig();
 }
 
 bool Finput::addline(const std::string& line)
@@ -303,6 +304,9 @@ void Finput::sanity_check()
     error("printing of diagrams with explicit spins not implemented yet.","Finput::sanity_check");
   if (Input::iPars["prog"]["explspin"] && Input::iPars["prog"]["spinintegr"])
     error("spinintegr and explspin are not allowed at the same time.","Finput::sanity_check");
+  // the equal terms for eqway>0 depend on the representatives kept from the full Wick's theorem
+  if (Input::config.connected > 0 && Input::config.eqway > 0)
+    error("connected and eqway>0 are not allowed at the same time. Set connected=0.","Finput::sanity_check");
 }
 
 std::ostream& operator<<(std::ostream& o, const Finput& inp)
@@ -39,7 +39,7 @@ public:
   // check input parameters for consistency
   void sanity_check();
   // clear all arrays
-  void clear() {_inlines.clear(); _ineq.clear(); _input.clear(); _eq = false;};
+  void clear() {_inlines.clear(); _ineq.clear(); _input.clear(); _eqns.clear(); _eq = false;};
   // return input lines
   const std::vector<std::string> & inlines() const { return _inlines;};
   const std::vector<std::string> & ineq() const { return _ineq;};
@@ -117,32 +117,297 @@ bool Output::breaklongline()
 namespace math {
 long int gcd(long int n1, long int n2) {
   if ( n2 == 0 || n2 == 1 || n1 == 1 ) return 1;
-  n1 = std::abs(n1);
-  n2 = std::abs(n2);
-  // Euclidean algorithm
-#if true
-  long int tmp;
-  while ( n2 != 0 ) {
-    tmp = n2;
-    n2 = n1 % n2;
-    n1 = tmp;
+  return bgcd(std::abs(n1),std::abs(n2));
+}
+TRational abs(const TRational& f){return (f.negative() ? -f : f);}
+double todouble(const TRational& f){return f.todouble();}
+
+BigInt::BigInt(TInt128 n)
+{
+  _neg = ( n < 0 );
+  TUInt128 m = ( _neg ? -TUInt128(n) : TUInt128(n) );
+  for ( ; m; m >>= 32 ) _mag.push_back(uint32_t(m));
+}
+void BigInt::trim()
+{
+  while ( !_mag.empty() && _mag.back() == 0 ) _mag.pop_back();
+  if ( _mag.empty() ) _neg = false;
+}
+bool BigInt::fitslong() const
+{
+  return ( _mag.size() < 2 || (_mag.size() == 2 && _mag[1] <= uint32_t(LONG_MAX >> 32)) );
+}
+long int BigInt::tolong() const
+{
+  uint64_t m = 0;
+  for ( uint i = _mag.size(); i > 0; --i ) m = m << 32 | _mag[i-1];
+  return ( _neg ? -long(m) : long(m) );
+}
+double BigInt::todouble() const
+{
+  double d = 0;
+  for ( uint i = _mag.size(); i > 0; --i ) d = std::ldexp(d,32) + _mag[i-1];
+  return ( _neg ? -d : d );
+}
+std::string BigInt::str() const
+{
+  if ( zero() ) return "0";
+  // divide by 10^9 repeatedly
+  Mag m(_mag);
+  std::string digits;
+  while ( !m.empty() ) {
+    uint64_t rem = 0;
+    for ( uint i = m.size(); i > 0; --i ) {
+      uint64_t cur = rem << 32 | m[i-1];
+      m[i-1] = uint32_t(cur/1000000000);
+      rem = cur%1000000000;
+    }
+    while ( !m.empty() && m.back() == 0 ) m.pop_back();
+    for ( int k = 0; k < 9 && (rem || !m.empty()); ++k, rem /= 10 )
+      digits.push_back(char('0'+rem%10));
   }
-#else
-  while ( n1 != n2 ) {
-    if (n1 > n2)
-      n1 -= n2;
-    else
-      n2 -= n1;
+  if ( _neg ) digits.push_back('-');
+  return std::string(digits.rbegin(),digits.rend());
+}
+int BigInt::cmpmag(const Mag& a, const Mag& b)
+{
+  if ( a.size() != b.size() ) return ( a.size() < b.size() ? -1 : 1 );
+  for ( uint i = a.size(); i > 0; --i )
+    if ( a[i-1] != b[i-1] ) return ( a[i-1] < b[i-1] ? -1 : 1 );
+  return 0;
+}
+int BigInt::compare(const BigInt& b) const
+{
+  if ( _neg != b._neg ) return ( _neg ? -1 : 1 );
+  int c = cmpmag(_mag,b._mag);
+  return ( _neg ? -c : c );
+}
+BigInt BigInt::operator+(const BigInt& b) const
+{
+  BigInt r;
+  if ( _neg == b._neg ) {
+    // add magnitudes
+    const Mag &x = ( _mag.size() >= b._mag.size() ? _mag : b._mag ),
+              &y = ( _mag.size() >= b._mag.size() ? b._mag : _mag );
+    uint64_t carry = 0;
+    for ( uint i = 0; i < x.size(); ++i ) {
+      carry += uint64_t(x[i]) + ( i < y.size() ? y[i] : 0 );
+      r._mag.push_back(uint32_t(carry));
+      carry >>= 32;
+    }
+    if ( carry ) r._mag.push_back(uint32_t(carry));
+    r._neg = _neg;
+  } else {
+    // subtract the smaller magnitude from the larger one
+    int c = cmpmag(_mag,b._mag);
+    if ( c == 0 ) return r;
+    const Mag &x = ( c > 0 ? _mag : b._mag ), &y = ( c > 0 ? b._mag : _mag );
+    int64_t borrow = 0;
+    for ( uint i = 0; i < x.size(); ++i ) {
+      int64_t diff = int64_t(x[i]) - ( i < y.size() ? y[i] : 0 ) - borrow;
+      borrow = ( diff < 0 );
+      r._mag.push_back(uint32_t(diff + (borrow << 32)));
+    }
+    r._neg = ( c > 0 ? _neg : b._neg );
   }
-#endif
-  return n1;
+  r.trim();
+  return r;
 }
-TRational abs(const TRational& f){return TRational(std::abs(f.numerator()),f.denominator());}
-double todouble(const TRational& f){return double(f.numerator())/double(f.denominator());}
+BigInt BigInt::operator*(const BigInt& b) const
+{
+  BigInt r;
+  if ( zero() || b.zero() ) return r;
+  r._mag.assign(_mag.size()+b._mag.size(),0);
+  for ( uint i = 0; i < _mag.size(); ++i ) {
+    uint64_t carry = 0;
+    for ( uint j = 0; j < b._mag.size(); ++j ) {
+      carry += uint64_t(_mag[i])*b._mag[j] + r._mag[i+j];
+      r._mag[i+j] = uint32_t(carry);
+      carry >>= 32;
+    }
+    r._mag[i+b._mag.size()] = uint32_t(carry);
+  }
+  r._neg = ( _neg != b._neg );
+  r.trim();
+  return r;
 }
-TRational operator/(long int i, const TRational& f){return TRational(i*f.denominator(),f.numerator());}
+void BigInt::divmod(const BigInt& b, BigInt& q, BigInt& r) const
+{
+  if ( b.zero() ) error("Division by zero","BigInt");
+  q = r = BigInt();
+  if ( cmpmag(_mag,b._mag) < 0 ) {
+    r._mag = _mag;
+    return;
+  }
+  // binary long division of the magnitudes
+  BigInt bb(b);
+  bb._neg = false;
+  q._mag.assign(_mag.size(),0);
+  for ( uint i = 32*_mag.size(); i > 0; --i ) {
+    uint bit = i-1;
+    // r = 2r + bit
+    uint32_t carry = (_mag[bit/32] >> (bit%32)) & 1;
+    for ( uint32_t& dig: r._mag ) {
+      uint32_t top = dig >> 31;
+      dig = dig << 1 | carry;
+      carry = top;
+    }
+    if ( carry ) r._mag.push_back(carry);
+    if ( cmpmag(r._mag,bb._mag) >= 0 ) {
+      r = r - bb;
+      q._mag[bit/32] |= uint32_t(1) << (bit%32);
+    }
+  }
+  q.trim();
+}
+BigInt BigInt::operator/(const BigInt& b) const
+{
+  BigInt q, r;
+  divmod(b,q,r);
+  q._neg = ( !q.zero() && _neg != b._neg );
+  return q;
+}
+BigInt BigInt::operator%(const BigInt& b) const
+{
+  BigInt q, r;
+  divmod(b,q,r);
+  r._neg = ( !r.zero() && _neg );
+  return r;
+}
+BigInt BigInt::gcd(BigInt a, BigInt b)
+{
+  a._neg = b._neg = false;
+  while ( !b.zero() ) {
+    BigInt t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+}
+void TRational::set(long int n, long int d)
+{
+  if ( d == 0 ) error("Division by zero","TRational");
+  TInt128 nn = n, dd = d;
+  if ( d < 0 ) {
+    nn = -nn;
+    dd = -dd;
+  }
+  uint64_t div = math::bgcd(uint64_t(nn < 0 ? -nn : nn),uint64_t(dd));
+  *this = reduced(nn/div,dd/div);
+}
+TRational TRational::reduced(TInt128 n, TInt128 d)
+{
+  if ( n > LONG_MAX || n < -LONG_MAX || d > LONG_MAX )
+    return reduced(math::BigInt(n),math::BigInt(d));
+  TRational r;
+  r._numerator = long(n);
+  r._denominator = long(d);
+  return r;
+}
+TRational TRational::reduced(const math::BigInt& n, const math::BigInt& d)
+{
+  TRational r;
+  if ( n.fitslong() && d.fitslong() ) {
+    r._numerator = n.tolong();
+    r._denominator = d.tolong();
+  } else
+    r._big = std::make_shared<const Big>(Big{n,d});
+  return r;
+}
+TRational TRational::add(long int n, long int d) const
+{
+  if ( _denominator == 1 && d == 1 ) return reduced(TInt128(_numerator)+n,1);
+  long int g = math::bgcd(_denominator,d);
+  if ( g == 1 ) return reduced(TInt128(_numerator)*d+TInt128(n)*_denominator,TInt128(_denominator)*d);
+  TInt128 t = TInt128(_numerator)*(d/g)+TInt128(n)*(_denominator/g);
+  long int g2 = math::bgcd(uint64_t((t < 0 ? -t : t) % g),g);
+  if ( g2 > 1 ) t /= g2;
+  return reduced(t,TInt128(_denominator/g)*(d/g2));
+}
+TRational TRational::mul(long int n, long int d) const
+{
+  if ( _numerator == 0 || n == 0 ) return TRational();
+  long int
+    g1 = math::bgcd(std::abs(_numerator),d),
+    g2 = math::bgcd(std::abs(n),_denominator);
+  return reduced(TInt128(_numerator/g1)*(n/g2),TInt128(_denominator/g2)*(d/g1));
+}
+TRational TRational::bigadd(const TRational& f, bool subtract) const
+{
+  math::BigInt fn = f.bignum();
+  if ( subtract ) fn = -fn;
+  math::BigInt
+    n = bignum()*f.bigden() + fn*bigden(),
+    d = bigden()*f.bigden(),
+    g = math::BigInt::gcd(n,d);
+  return reduced(n/g,d/g);
+}
+TRational TRational::bigmul(const TRational& f, bool divide) const
+{
+  math::BigInt fn = f.bignum(), fd = f.bigden();
+  if ( divide ) {
+    if ( fn.zero() ) error("Division by zero","TRational");
+    std::swap(fn,fd);
+    if ( fd.negative() ) {
+      fn = -fn;
+      fd = -fd;
+    }
+  }
+  math::BigInt n = bignum()*fn;
+  if ( n.zero() ) return TRational();
+  math::BigInt
+    d = bigden()*fd,
+    g = math::BigInt::gcd(n,d);
+  return reduced(n/g,d/g);
+}
+bool TRational::bigequal(const TRational& f) const
+{
+  // a big number never equals a small one
+  return ( _big && f._big && _big->n == f._big->n && _big->d == f._big->d );
+}
+int TRational::bigcompare(const TRational& f) const
+{
+  return (bignum()*f.bigden()).compare(f.bignum()*bigden());
+}
+TRational TRational::operator-() const
+{
+  TRational r;
+  if ( _big )
+    r._big = std::make_shared<const Big>(Big{-_big->n,_big->d});
+  else {
+    r._numerator = -_numerator;
+    r._denominator = _denominator;
+  }
+  return r;
+}
+TRational TRational::operator/(const TRational& f) const
+{
+  if ( _big || f._big ) return bigmul(f,true);
+  if ( f._numerator == 0 ) error("Division by zero","TRational");
+  if ( f._numerator < 0 )
+    return mul(-f._denominator,-f._numerator);
+  return mul(f._denominator,f._numerator);
+}
+double TRational::todouble() const
+{
+  if ( _big ) return _big->n.todouble()/_big->d.todouble();
+  return double(_numerator)/double(_denominator);
+}
+TRational operator/(long int i, const TRational& f){return TRational(i)/f;}
 std::ostream & operator << (std::ostream & o, TRational const & p){
-  int digits = 0, number = std::max(std::abs(p.numerator()),std::abs(p.denominator()));
+  int digits = 0;
+  if ( p.big() ) {
+    std::string num = p.numstr(), den = p.denstr();
+    digits = std::max(num.size(),den.size());
+    if ( den != "1" )
+      o << "\\frac{" << num << "}{" << den << "}" ;
+    else
+      o << num;
+    MyOut::pcurout->lenbuf += digits;
+    return o;
+  }
+  long int number = std::max(std::abs(p.numerator()),std::abs(p.denominator()));
   if ( p.numerator() < 0 || p.denominator() < 0 ) ++digits;
   do { number /= 10; ++digits; } while(number);
   if ( p.denominator() != 1 )
@@ -157,5 +422,54 @@ TsParSet Input::sPars;
 TiParSet Input::iPars;
 TfParSet Input::fPars;
 TaParSet Input::aPars;
+static Input::Config inpconfig;
+const Input::Config& Input::config = inpconfig;
+
+// parameter value or default (don't insert missing parameters)
+template <class ParSet, class T>
+static T inppar(const ParSet& pars, const std::string& set, const std::string& name, const T& def)
+{
+  auto its = pars.find(set);
+  if ( its == pars.end() ) return def;
+  auto itn = its->second.find(name);
+  if ( itn == its->second.end() ) return def;
+  return itn->second;
+}
+void Input::setconfig()
+{
+  Config& c = inpconfig;
+  c.explspin = inppar(iPars,"prog","explspin",0);
+  c.spinintegr = inppar(iPars,"prog","spinintegr",0);
+  c.dmsort = inppar(iPars,"prog","dmsort",0);
+  c.quan3 = inppar(iPars,"prog","quan3",0);
+  c.algo = inppar(iPars,"prog","algo",0);
+  c.permuteq = inppar(iPars,"prog","permuteq",0);
+  c.eqcanon = inppar(iPars,"prog","eqcanon",0);
+  c.eqprune = inppar(iPars,"prog","eqprune",0);
+  c.eqcache = inppar(iPars,"prog","eqcache",0);
+  c.multiref = inppar(iPars,"prog","multiref",0);
+  c.noorder = inppar(iPars,"prog","noorder",0);
+  c.replacee0 = inppar(iPars,"prog","replacee0",0);
+  c.contrexcop = inppar(iPars,"prog","contrexcop",0);
+  c.nobrafac = inppar(iPars,"prog","nobrafac",0);
+  c.wickmemo = inppar(iPars,"prog","wickmemo",0);
+  c.wickcache = inppar(iPars,"prog","wickcache",0);
+  c.connected = inppar(iPars,"prog","connected",0);
+  c.threads = inppar(iPars,"prog","threads",0);
+  c.fused = inppar(iPars,"prog","fused",0);
+  c.arena = inppar(iPars,"prog","arena",0);
+  c.eqway = inppar(iPars,"prog","eqway",0);
+  c.nocc = inppar(iPars,"fact","nocc",0);
+  c.nvir = inppar(iPars,"fact","nvir",0);
+  c.nact = inppar(iPars,"fact","nact",0);
+  c.occorb = inppar(sPars,"syntax","occorb",std::string());
+  c.virorb = inppar(sPars,"syntax","virorb",std::string());
+  c.actorb = inppar(sPars,"syntax","actorb",std::string());
+  c.genorb = inppar(sPars,"syntax","genorb",std::string());
+  c.exc0 = inppar(sPars,"output","exc0",std::string());
+  c.e0 = inppar(sPars,"hamilton","E0",std::string());
+  TParArray dg = inppar(aPars,"syntax","dg",TParArray());
+  c.dg = dg.empty() ? std::string() : dg.front();
+}
 Output MyOut::defout;
 Output * MyOut::pcurout = &MyOut::defout;
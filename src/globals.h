@@ -5,7 +5,12 @@
 #include <sstream>
 #include <map>
 #include <list>
+#include <vector>
+#include <memory>
 #include <cmath>
+#include <climits>
+#include <utility>
+#include <stdint.h>
 #include "utilities.h"
 
 typedef long unsigned int lui;
@@ -21,42 +26,136 @@ typedef std::map< std::string, TiPar > TiParSet;
 typedef std::map< std::string, TfPar > TfParSet;
 typedef std::map< std::string, TaPar > TaParSet;
 
+// 128-bit integers for intermediate results
+__extension__ typedef __int128 TInt128;
+__extension__ typedef unsigned __int128 TUInt128;
+
 namespace math {
 // greatest common divisor
 long int gcd(long int n1, long int n2);
+// greatest common divisor of non-negative numbers (binary algorithm, gcd(0,n) = n)
+inline uint64_t bgcd(uint64_t u, uint64_t v)
+{
+  if ( u == 0 ) return v;
+  if ( v == 0 ) return u;
+  int shift = __builtin_ctzll(u|v);
+  u >>= __builtin_ctzll(u);
+  do {
+    v >>= __builtin_ctzll(v);
+    if ( u > v ) std::swap(u,v);
+    v -= u;
+  } while ( v != 0 );
+  return u << shift;
+}
+// arbitrary-precision integers (only for the rational numbers which don't fit in 64 bit)
+class BigInt
+{
+public:
+  BigInt(TInt128 n = 0);
+  bool negative() const { return _neg; };
+  bool zero() const { return _mag.empty(); };
+  // in [-LONG_MAX,LONG_MAX]?
+  bool fitslong() const;
+  // (only if fitslong())
+  long int tolong() const;
+  double todouble() const;
+  std::string str() const;
+  BigInt operator-() const { BigInt r(*this); r._neg = !r._neg && !r.zero(); return r; };
+  BigInt operator+(const BigInt& b) const;
+  BigInt operator-(const BigInt& b) const { return *this + (-b); };
+  BigInt operator*(const BigInt& b) const;
+  // truncated division
+  BigInt operator/(const BigInt& b) const;
+  BigInt operator%(const BigInt& b) const;
+  // -1, 0, 1
+  int compare(const BigInt& b) const;
+  bool operator==(const BigInt& b) const { return _neg == b._neg && _mag == b._mag; };
+  // greatest common divisor of |a| and |b|
+  static BigInt gcd(BigInt a, BigInt b);
+private:
+  typedef std::vector<uint32_t> Mag;
+  // |this| = q*|b| + r
+  void divmod(const BigInt& b, BigInt& q, BigInt& r) const;
+  static int cmpmag(const Mag& a, const Mag& b);
+  // remove leading zeros
+  void trim();
+  bool _neg = false;
+  // magnitude (32-bit digits, least significant first, no leading zeros)
+  Mag _mag;
+};
 }
 // rational numbers
+// exact: intermediate results are calculated with 128-bit integers and reduced
+// (Knuth's algorithms for multiplication and addition),
+// a result which doesn't fit in 64 bit is kept in big integers
 class TRational
 {
 public:
   TRational() {};
-  TRational(long int n,long int d = 1) : _numerator(n), _denominator(d){normalize();};
+  TRational(long int n,long int d = 1) { if (d == 1 && n >= -LONG_MAX) _numerator = n; else set(n,d); };
 //   TRational(const TRational& f) : _numerator(f._numerator),_denominator(f._denominator){};
+  // numerator and denominator (only if !big())
   long int numerator() const { return _numerator; };
   long int denominator() const { return _denominator; };
+  bool big() const { return bool(_big); };
+  bool negative() const { return ( _big ? _big->n.negative() : _numerator < 0 ); };
+
+  TRational & operator*=(const TRational& f){ return *this = *this * f; };
+  TRational & operator/=(const TRational& f){ return *this = *this / f; };
+  TRational & operator+=(const TRational& f){ return *this = *this + f; };
+  TRational & operator-=(const TRational& f){ return *this = *this - f; };
+
+  TRational operator*(const TRational& f) const
+    { return ( _big || f._big ? bigmul(f,false) : mul(f._numerator,f._denominator) ); };
+  TRational operator/(const TRational& f) const;
+  TRational operator+(const TRational& f) const
+    { return ( _big || f._big ? bigadd(f,false) : add(f._numerator,f._denominator) ); };
+  TRational operator-(const TRational& f) const
+    { return ( _big || f._big ? bigadd(f,true) : add(-f._numerator,f._denominator) ); };
+  TRational operator-() const;
 
-  TRational & operator*=(const TRational& f){ _numerator*= f._numerator; _denominator*= f._denominator; normalize(); return *this;};
-  TRational & operator/=(const TRational& f){ _numerator*= f._denominator; _denominator*= f._numerator; normalize(); return *this;};
-  TRational & operator+=(const TRational& f){ _numerator*= f._denominator; _numerator+= f._numerator*_denominator; _denominator*= f._denominator; normalize(); return *this;};
-  TRational & operator-=(const TRational& f){ _numerator*= f._denominator; _numerator-= f._numerator*_denominator; _denominator*= f._denominator; normalize(); return *this;};
-
-  TRational operator*(const TRational& f) const { return TRational(_numerator*f._numerator,_denominator*f._denominator);};
-  TRational operator/(const TRational& f) const { return TRational(_numerator*f._denominator,_denominator*f._numerator);};
-  TRational operator+(const TRational& f) const { return TRational(_numerator*f._denominator+f._numerator*_denominator,_denominator*f._denominator);};
-  TRational operator-(const TRational& f) const { return TRational(_numerator*f._denominator-f._numerator*_denominator,_denominator*f._denominator);};
-  TRational operator-() const { return TRational(-_numerator,_denominator);};
-
-  bool operator<(const TRational& f) const { return (_numerator*f._denominator < f._numerator*_denominator);};
-  bool operator<=(const TRational& f) const { return (_numerator*f._denominator <= f._numerator*_denominator);};
-  bool operator>(const TRational& f) const { return (_numerator*f._denominator > f._numerator*_denominator);};
-  bool operator>=(const TRational& f) const { return (_numerator*f._denominator >= f._numerator*_denominator);};
-  bool operator==(const TRational& f) const { return (_numerator*f._denominator == f._numerator*_denominator);};
-  bool operator!=(const TRational& f) const { return (_numerator*f._denominator != f._numerator*_denominator);};
+  bool operator<(const TRational& f) const { return compare(f) < 0;};
+  bool operator<=(const TRational& f) const { return compare(f) <= 0;};
+  bool operator>(const TRational& f) const { return compare(f) > 0;};
+  bool operator>=(const TRational& f) const { return compare(f) >= 0;};
+  // both are reduced (and big only if they don't fit in 64 bit)
+  bool operator==(const TRational& f) const
+    { return ( _big || f._big ? bigequal(f) : _numerator == f._numerator && _denominator == f._denominator );};
+  bool operator!=(const TRational& f) const { return !(*this == f);};
+  // -1, 0, 1
+  int compare(const TRational& f) const {
+    if ( _big || f._big ) return bigcompare(f);
+    TInt128 l = TInt128(_numerator)*f._denominator, r = TInt128(f._numerator)*_denominator;
+    return ( l < r ? -1 : ( l > r ? 1 : 0 ) );
+  };
+  double todouble() const;
+  // numerator and denominator as decimal strings
+  std::string numstr() const { return ( _big ? _big->n.str() : std::to_string(_numerator) ); };
+  std::string denstr() const { return ( _big ? _big->d.str() : std::to_string(_denominator) ); };
 private:
+  // reduced, _denominator > 0, both in [-LONG_MAX,LONG_MAX]
   long int _numerator = 0, _denominator = 1;
-  void normalize() {long int div = math::gcd(_numerator,_denominator);
-                    if (_denominator < 0) div = -div;
-                    _numerator /= div; _denominator /= div; };
+  // reduced n/d (d > 0) if it doesn't fit in 64 bit (then _numerator and _denominator are unused)
+  struct Big {
+    math::BigInt n, d;
+  };
+  std::shared_ptr<const Big> _big;
+  // reduce n/d and set
+  void set(long int n, long int d);
+  // n/d (already reduced, d > 0), big if it doesn't fit
+  static TRational reduced(TInt128 n, TInt128 d);
+  static TRational reduced(const math::BigInt& n, const math::BigInt& d);
+  // *this + n/d and *this * n/d (n/d reduced, d > 0)
+  TRational add(long int n, long int d) const;
+  TRational mul(long int n, long int d) const;
+  // numerator and denominator as big integers
+  math::BigInt bignum() const { return ( _big ? _big->n : math::BigInt(_numerator) ); };
+  math::BigInt bigden() const { return ( _big ? _big->d : math::BigInt(_denominator) ); };
+  // *this +- f, *this * f or *this / f with big integers
+  TRational bigadd(const TRational& f, bool subtract) const;
+  TRational bigmul(const TRational& f, bool divide) const;
+  bool bigequal(const TRational& f) const;
+  int bigcompare(const TRational& f) const;
 };
 TRational operator/(long int i, const TRational& f);
 namespace math{
@@ -164,6 +263,26 @@ namespace Input
   extern TfParSet fPars;
   //array of string parameters
   extern TaParSet aPars;
+  // typed copy of the parameters which are used in the hot paths
+  // (read-only, thread-safe, no map lookups)
+  struct Config {
+    // prog
+    int explspin, spinintegr, dmsort, quan3, algo, permuteq, eqcanon, eqprune, eqcache, multiref, noorder,
+        replacee0, contrexcop, nobrafac, wickmemo, wickcache, connected, threads, fused, arena, eqway;
+    // fact
+    int nocc, nvir, nact;
+    // syntax: names of the orbitals
+    std::string occorb, virorb, actorb, genorb;
+    // output
+    std::string exc0;
+    // hamilton
+    std::string e0;
+    // syntax: dagger
+    std::string dg;
+  };
+  extern const Config& config;
+  // update config from the parameters (has to be called after each change of the parameters)
+  void setconfig();
 }
 
 #define xout std::cout
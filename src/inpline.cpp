@@ -65,6 +65,7 @@ lui IL::addnewcom(const std::string& str, lui ipos, std::string what)
     error("empty value in \\"+what+" "+str);
   std::string value(str.substr(ipos,skipr(str,ipend," ")-ipos));
   Input::sPars[what][name] = value;
+  Input::setconfig();
   return ipend+1;
 }
 void IL::changePars(const std::string& str, lui ipos)
@@ -112,6 +113,7 @@ void IL::changePars(const std::string& str, lui ipos)
       error(set+":"+name+" : unrecognized name");
     }
   }
+  Input::setconfig();
 }
 
 lui IL::skip(const std::string& str, const lui& ipos, const std::string& what)
@@ -11,6 +11,7 @@
 #include "globals.h"
 #include "work.h"
 #include "tensor.h"
+#include "arena.h"
 
 using namespace std;
 using namespace ArgParser;
@@ -101,12 +102,20 @@ int main(int argc, char **argv) {
     if ( exists(algofile) )
       std::remove(algofile.c_str());
   }
+  // minimized diagrams of previous runs
+  std::string eqcfile;
+  if ( Input::config.eqcache > 1 ) {
+    eqcfile = DirName(inputfile)+FileName(inputfile,true)+".eqc";
+    UniGraphCache::load(eqcfile);
+  }
   //loop over all lines in the input file
   for ( lui il = 0; il < inp.size(); ++il ){
     if ( algo ) {
     } 
     else if ( finput.addline(inp[il]) ){
       //detected equation in input line
+      // all terms of the equation are allocated in the arena and freed at once at the end
+      Arena::Scope arena(Input::config.arena > 0);
       finput.analyzeq();
       if ( finput.sumterms().size() == 0 ){
         say("Empty equation!");
@@ -166,6 +175,8 @@ int main(int argc, char **argv) {
   // set current ouput back to default
   MyOut::pcurout = &MyOut::defout;
   fout.close();
+  if ( !eqcfile.empty() )
+    UniGraphCache::save(eqcfile);
 
 //   // test nextwordpos
 //   std::string
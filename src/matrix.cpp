@@ -1,4 +1,6 @@
 #include "matrix.h"
+#include <mutex>
+#include <map>
 
 Product< Orbital > Ops::genprodorb(short int exccl, const Orbital& occ, const Orbital& virt)
 {
@@ -19,7 +21,7 @@ Product< Orbital > Ops::genprodorb(short int exccl, const Orbital& occ, const Or
 
 std::vector<uint> Matrix::calc_virtelvec(const Product<Orbital>& inorbs) const
 {
-  std::vector<uint> virtelvec (_npairs);
+  std::vector<uint> virtelvec (_props->npairs);
   for(uint i = 0; i < virtelvec.size(); i++){
     if( inorbs[i*2].type() == Orbital::Virt ) virtelvec[i]++;
     if( inorbs[(i*2)+1].type() == Orbital::Virt ) virtelvec[i]++;
@@ -104,7 +106,7 @@ Matrix::Matrix(Ops::Type t, const Product< Orbital >& pcrea, const Product< Orbi
 {
   assert( pcrea.size() == panni.size()+lmel );
   _orbs.reserve(pcrea.size()+panni.size());
-  if ( t == Ops::DensM && Input::iPars["prog"]["dmsort"] > 0 ) {
+  if ( t == Ops::DensM && Input::config.dmsort > 0 ) {
     // different order of electrons: 1,2,...2, 1
     for (const auto& orb: pcrea){
       _orbs.push_back(orb);
@@ -146,24 +148,26 @@ Matrix::Matrix(const Kronecker& d, bool ordered)
 void Matrix::create_Matrix(Ops::Type t, uint npairs, short int lmel, short int pmsym,
                            std::string name, Matrix::Spinsym matspinsym, bool antisymW)
 {
-  _type=t;
-  gen_name(name);
-  _npairs=npairs;
-  assert(_npairs <= _orbs.size()/2);
-  _lmel = lmel;
-  _pmsym = pmsym;
-  assert(2*_npairs+std::abs(_lmel) == _orbs.size());
-  assert((_orbs.size()-_lmel)%2 == 0 && (_orbs.size()+_lmel)%2 == 0 );
-  _matspinsym=matspinsym;
+  Props props;
+  props.type = t;
+  props.name = gen_name(t,name);
+  props.npairs = npairs;
+  assert(npairs <= _orbs.size()/2);
+  props.lmel = lmel;
+  props.pmsym = pmsym;
+  assert(2*npairs+std::abs(lmel) == _orbs.size());
+  assert((_orbs.size()-lmel)%2 == 0 && (_orbs.size()+lmel)%2 == 0 );
+  props.matspinsym = matspinsym;
   _internal = true;
   if (t==Ops::FluctP)
-    _antisymform=antisymW;
-  else if ( t==Ops::Exc && Input::iPars["prog"]["quan3"] > 0 ) {
+    props.antisymform = antisymW;
+  else if ( t==Ops::Exc && Input::config.quan3 > 0 ) {
     // make amplitudes antisymmetrical (now works only for doubles!)
     assert(_orbs.size() == 4);
-    _antisymform=true;
+    props.antisymform = true;
   } else
-    _antisymform=false;
+    props.antisymform = false;
+  _props = intern(props);
   _exccl = _intlines = _intvirt = _orbtypeshash = 0;
   if ( name == "U" && npairs == 3 )
     _threeelectronint = true;
@@ -171,59 +175,87 @@ void Matrix::create_Matrix(Ops::Type t, uint npairs, short int lmel, short int p
     _threeelectronint = false;
 }
 
-void Matrix::gen_name(const std::string& name)
+bool Matrix::Props::operator<(const Props& p) const
 {
-  std::string exc0 = Input::sPars["output"]["exc0"];
+  if ( type != p.type ) return type < p.type;
+  if ( name != p.name ) return name < p.name;
+  if ( npairs != p.npairs ) return npairs < p.npairs;
+  if ( lmel != p.lmel ) return lmel < p.lmel;
+  if ( pmsym != p.pmsym ) return pmsym < p.pmsym;
+  if ( matspinsym != p.matspinsym ) return matspinsym < p.matspinsym;
+  return antisymform < p.antisymform;
+}
+
+const Matrix::Props * Matrix::intern(const Props& props)
+{
+  static std::mutex mtx;
+  static std::set<Props> entries;
+  // front cache of each thread, the shared set is locked only for properties new to the thread
+  thread_local std::map<Props,const Props *> cache;
+  auto ic = cache.find(props);
+  if ( ic != cache.end() ) return ic->second;
+  const Props * pprops;
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    pprops = &*entries.insert(props).first;
+  }
+  cache.emplace(props,pprops);
+  return pprops;
+}
+
+std::string Matrix::gen_name(Ops::Type type, const std::string& name)
+{
+  const std::string& exc0 = Input::config.exc0;
+  std::string genname;
   // replace default name
   if ( name == "T" ) {
-    switch (_type) {
+    switch (type) {
       case Ops::Fock:
-        _name = "f";
+        genname = "f";
         break;
       case Ops::OneEl:
-        _name = "h";
+        genname = "h";
         break;
       case Ops::FluctP:
-        _name = "W";
+        genname = "W";
         break;
       case Ops::XPert:
-        _name = "X";
+        genname = "X";
         break;
       case Ops::Overlap:
-        _name = "S";
+        genname = "S";
         break;
       case Ops::DensM:
-        _name = "\\gamma";
+        genname = "\\gamma";
         break;
       case Ops::Delta:
-        _name = "\\delta";
+        genname = "\\delta";
         // fall through
       case Ops::Exc0:
         // fall through
       case Ops::Deexc0:
         if (exc0 != " "){
-          _name = exc0;
-          if ( _type == Ops::Deexc0 ) // add dagger
-            IL::add2name(_name,Input::aPars["syntax"]["dg"].front());
+          genname = exc0;
+          if ( type == Ops::Deexc0 ) // add dagger
+            IL::add2name(genname,Input::config.dg);
           break;
         }
         // fall through
       default:
-        _name=name;
+        genname=name;
     }
   } else {
-    _name=name;
+    genname=name;
   }
+  return genname;
 }
 Ops::Type Matrix::type() const
-{ return _type; }
+{ return _props->type; }
 const Product< Orbital >& Matrix::orbitals() const
 { return _orbs; }
 
-std::string Matrix::name() const
-{ return _name; }
 bool Matrix::antisymform() const
-{ return _antisymform; }
+{ return _props->antisymform; }
 bool Matrix::is_internal(const TOrbSet& sumorbs)
 {
   _internal = true;
@@ -238,16 +270,19 @@ bool Matrix::is_internal(const TOrbSet& sumorbs)
 
 void Matrix::combine(const Matrix& mat, const Set< uint >& dontorbs)
 {
-  if ( InSet(_type,Ops::Deexc0,Ops::Exc0) )
-    _name = mat._name;
-  else if ( !InSet(mat._type,Ops::Deexc0,Ops::Exc0) )
-    IL::add2name(_name,mat._name);
-  if ( dontorbs.size() == mat._orbs.size() )
+  Props props(*_props);
+  if ( InSet(props.type,Ops::Deexc0,Ops::Exc0) )
+    props.name = mat._props->name;
+  else if ( !InSet(mat._props->type,Ops::Deexc0,Ops::Exc0) )
+    IL::add2name(props.name,mat._props->name);
+  if ( dontorbs.size() == mat._orbs.size() ) {
     // don't have to unite anything
+    _props = intern(props);
     return;
-  if ( _matspinsym != mat._matspinsym || _matspinsym != Singlet )
+  }
+  if ( props.matspinsym != mat._props->matspinsym || props.matspinsym != Singlet )
     Error("Cannot combine non-Singlet matrices yet");
-  if ( 2*_npairs != _orbs.size() || 2*mat._npairs != mat._orbs.size() )
+  if ( 2*props.npairs != _orbs.size() || 2*mat._props->npairs != mat._orbs.size() )
     Error("Cannot combine non-conserving matrices yet");
   // combine orbitals (excluding those in dontorbs)
   for ( uint io = 0; io < mat._orbs.size(); ++io ){
@@ -257,7 +292,8 @@ void Matrix::combine(const Matrix& mat, const Set< uint >& dontorbs)
       assert( dontorbs.count(mat.iorbel(io)) == 0 );
     }
   }
-  _npairs = _orbs.size()/2;
+  props.npairs = _orbs.size()/2;
+  _props = intern(props);
 }
 
 Return Matrix::replace(Orbital orb1, Orbital orb2, bool smart)
@@ -286,14 +322,16 @@ Return Matrix::replace(Spin spin1, Spin spin2, bool smart)
 
 bool Matrix::expandantisym(bool firstpart)
 {
-  if (_antisymform) {
+  if (_props->antisymform) {
     // works atm for doubles only!
     assert(_orbs.size() == 4);
-    if (_type!=Ops::FluctP && !( _type==Ops::Exc && Input::iPars["prog"]["quan3"] > 0 ))
+    if (_props->type!=Ops::FluctP && !( _props->type==Ops::Exc && Input::config.quan3 > 0 ))
       error("Can not expand antisymmetrical non-integral","Matrix::expandantisym");
     if (_orbs[0].spin().type()==Spin::No)
       error("Can not expand antisymmetrical integral in space orbitals","Matrix::expandantisym");
-    _antisymform=false;
+    Props props(*_props);
+    props.antisymform = false;
+    _props = intern(props);
     if (!firstpart) { // (PQ|RS) -> (PS|RQ)
       std::swap(_orbs[1],_orbs[3]);
     }
@@ -304,10 +342,10 @@ bool Matrix::expandantisym(bool firstpart)
 }
 bool Matrix::nonsingldm() const
 {
-  if ( _type != Ops::DensM ) return false;
+  if ( _props->type != Ops::DensM ) return false;
   assert( _orbs.size()%2 == 0 );
   assert( _orbs.size() == _cranorder.size() );
-  bool dmsort = (Input::iPars["prog"]["dmsort"] > 0);
+  bool dmsort = (Input::config.dmsort > 0);
   if (dmsort) {
     // a^\dg(1)  a^\dg(2) ... a(2) a(1)
     for ( uint i = 0, j = _orbs.size()-1; i < _orbs.size()/2; ++i, --j ){
@@ -323,25 +361,31 @@ bool Matrix::nonsingldm() const
 }
 bool Matrix::operator<(const Matrix& t) const
 {
-  if ( _type < t._type ) return true;
-  if ( t._type < _type ) return false;
-  if ( _name < t._name ) return true;
-  if ( t._name < _name ) return false;
-  if ( _npairs < t._npairs ) return true;
-  if ( t._npairs < _npairs ) return false;
-  if (_type == Ops::FluctP) { // electron-symmetry
+  // shared properties are equal
+  if ( _props != t._props ) {
+    if ( _props->type < t._props->type ) return true;
+    if ( t._props->type < _props->type ) return false;
+    if ( _props->name < t._props->name ) return true;
+    if ( t._props->name < _props->name ) return false;
+    if ( _props->npairs < t._props->npairs ) return true;
+    if ( t._props->npairs < _props->npairs ) return false;
+  }
+  if (_props->type == Ops::FluctP) { // electron-symmetry
     if ( *this == t ) return false; // the Matrix are the same
   }
   return _orbs < t._orbs;
 }
 bool Matrix::operator==(const Matrix& t) const
 {
-  if ( _type != t._type || _name != t._name ) return false;
-  if ( _orbs.size() != t._orbs.size() || _npairs != t._npairs || _lmel != t._lmel ) return false;
+  if ( _props != t._props ) {
+    if ( _props->type != t._props->type || _props->name != t._props->name ) return false;
+    if ( _props->npairs != t._props->npairs || _props->lmel != t._props->lmel ) return false;
+  }
+  if ( _orbs.size() != t._orbs.size() ) return false;
   if ( _orbs == t._orbs ) return true;
-  if (_type == Ops::FluctP) { // electron-symmetry
+  if (_props->type == Ops::FluctP) { // electron-symmetry
     if (_orbs.subprod(0,1) == t._orbs.subprod(2,3) && _orbs.subprod(2,3) == t._orbs.subprod(0,1) ) return true;
-  }// else if (InSet(_type, Ops::Exc,Ops::Deexc)) { // electron-symmetry
+  }// else if (InSet(_props->type, Ops::Exc,Ops::Deexc)) { // electron-symmetry
 
    // for (unsigned int i=0; i<_orbs.size()/2; i++) {
    //   for (unsigned int j=i; j<t._orbs.size()/2; j++) {
@@ -353,24 +397,29 @@ bool Matrix::operator==(const Matrix& t) const
 }
 bool Matrix::equivalent(const Matrix& mat) const
 {
-  return ( _type == mat._type && _name == mat._name &&
-           _npairs == mat._npairs && _lmel == mat._lmel &&
+  return ( _props->type == mat._props->type && _props->name == mat._props->name &&
+           _props->npairs == mat._props->npairs && _props->lmel == mat._props->lmel &&
            _orbs.size() == mat._orbs.size() && _orbtypeshash == mat._orbtypeshash );
 }
+uint64_t Matrix::equivkey() const
+{
+  return std::hash<std::string>()(_props->name) ^ (uint64_t(_props->type) << 48) ^ (uint64_t(_props->npairs) << 56) ^
+         (uint64_t(uint16_t(_props->lmel)) << 40) ^ (uint64_t(_orbs.size()) << 32) ^ (_orbtypeshash * 0x9E3779B97F4A7C15ull);
+}
 Equivalents Matrix::equivertices(uint offs) const
 {
   Equivalents everts;
   // is it an ordered density matrix?
-  bool dmo = (_type == Ops::DensM && Input::iPars["prog"]["dmsort"] > 0);
+  bool dmo = (_props->type == Ops::DensM && Input::config.dmsort > 0);
   EquiVertices ev;
   OrbitalTypes curorbts;
   // electrons (orbital pairs)
   uint nextvert = 0;
-  if ( nextvert < _npairs ) do {
+  if ( nextvert < _props->npairs ) do {
     uint startvert = nextvert;
     nextvert = 0;
     curorbts = orbtypes4vertex(startvert,dmo);
-    for ( uint vert = startvert; vert < _npairs; ++vert ) {
+    for ( uint vert = startvert; vert < _props->npairs; ++vert ) {
       if ( curorbts == orbtypes4vertex(vert,dmo) ){
         if ( dmo || spinsym(vert*2) == Singlet )
           ev.add(vert+offs);
@@ -382,7 +431,7 @@ Equivalents Matrix::equivertices(uint offs) const
     ev.clear();
   } while (nextvert > 0);
   // non-conserved electrons (single orbitals)
-  nextvert = _npairs;
+  nextvert = _props->npairs;
   if ( nextvert < nvertices()) do {
     uint startvert = nextvert;
     nextvert = 0;
@@ -408,28 +457,28 @@ Product< Orbital > Matrix::crobs(bool anni) const
     mult = 2,
     offs = anni ? 1 : 0,
     begin = 0,
-    end = _npairs,
+    end = _props->npairs,
     add = 1;
-  if ( _type == Ops::DensM ) {
-    if ( Input::iPars["prog"]["dmsort"] > 0 ) {
+  if ( _props->type == Ops::DensM ) {
+    if ( Input::config.dmsort > 0 ) {
       // different order of electrons: 1,2,...2, 1
       // note that here we exchange creators and annihilators in order to correspond to connections
       // i.e., for something like T^v_u \gamma^u_v we call "u" in gamma annihilator and "v" - creator!
       mult = 1;
       offs = 0;
       if ( !anni ){
-        begin = 2*_npairs-1;
-        end = _npairs-1;
+        begin = 2*_props->npairs-1;
+        end = _props->npairs-1;
         add = -1;
       }
     } else {
       // use order stored in _cranorder
-      for ( uint iorb = 0; iorb < 2*_npairs; ++iorb ){
+      for ( uint iorb = 0; iorb < 2*_props->npairs; ++iorb ){
         if ( (_cranorder[iorb] == SQOpT::Creator) == anni )
           orbs.push_back(_orbs[iorb]);
       }
     }
-//   } else if ( _type == Ops::Delta ) {
+//   } else if ( _props->type == Ops::Delta ) {
 //     // exchange creators and annihilators in order to correspond to connections (cf. density matrices)
 //     offs = anni ? 0 : 1;
   }
@@ -437,8 +486,8 @@ Product< Orbital > Matrix::crobs(bool anni) const
     orbs.push_back(_orbs[mult*vert+offs]);
   }
   // non-conserved electrons
-  if ( anni == (_lmel < 0) ){
-    for ( uint vert = 2*_npairs; vert < _orbs.size(); ++vert ){
+  if ( anni == (_props->lmel < 0) ){
+    for ( uint vert = 2*_props->npairs; vert < _orbs.size(); ++vert ){
       orbs.push_back(_orbs[vert]);
     }
   }
@@ -447,7 +496,7 @@ Product< Orbital > Matrix::crobs(bool anni) const
 OrbitalTypes Matrix::orbtypes4vertex(uint vertex, bool dmo) const
 {
   OrbitalTypes orbts;
-  if ( vertex < _npairs ){
+  if ( vertex < _props->npairs ){
     if ( dmo ) {
       // orbitals4vertices: 1 2 3 3 2 1
       orbts.push_back(_orbs[vertex].type());
@@ -459,8 +508,8 @@ OrbitalTypes Matrix::orbtypes4vertex(uint vertex, bool dmo) const
     }
   } else {
     // non-conserved electrons
-    assert( vertex < _npairs + std::abs(_lmel) );
-    orbts.push_back(_orbs[_npairs+vertex].type());
+    assert( vertex < _props->npairs + std::abs(_props->lmel) );
+    orbts.push_back(_orbs[_props->npairs+vertex].type());
   }
   return orbts;
 }
@@ -479,9 +528,9 @@ bool Matrix::samespin() const
 bool Matrix::vertices(long int ipos, Matrix& mat, long int ipos1, unsigned int indx)
 {
   // compare types, excitation classes and index of matrix
-  if (_type != mat._type || _name != mat._name || _orbs.size() != mat._orbs.size() || _indx != mat._indx) return false;
+  if (_props->type != mat._props->type || _props->name != mat._props->name || _orbs.size() != mat._orbs.size() || _indx != mat._indx) return false;
   // in the case of external indices orbitals should match exactly
-  //if ((_type == Ops::Exc0 || _type == Ops::Deexc0)&&_orbs[ipos]!=mat._orbs.at(ipos)) return false;
+  //if ((_props->type == Ops::Exc0 || _props->type == Ops::Deexc0)&&_orbs[ipos]!=mat._orbs.at(ipos)) return false;
   // compare spin symmetries
   if (spinsym(ipos) != mat.spinsym(ipos1)) return false;
   // set index of matrix (if not set)
@@ -515,7 +564,7 @@ const ConLine& Matrix::conline(lui iorb) const
 }
 bool Matrix::is0() const
 {
-  if (_type == Ops::DensM){
+  if (_props->type == Ops::DensM){
     if ( _orbs.size()%2 != 0 ) return true;
     // only active orbitals!
     for (const auto& orb: _orbs){
@@ -536,14 +585,14 @@ bool Matrix::is0() const
 
 void Matrix::set_cran(const Product< SQOpT::Gender >& cran)
 {
-  assert( _type == Ops::DensM );
+  assert( _props->type == Ops::DensM );
   assert( cran.size() == _orbs.size() );
   _cranorder = cran;
 }
 
 void Matrix::set_orbs( Product<Orbital>& crobs, Product<Orbital>& anobs )
 {
-  for( uint i = 0; i != _npairs; i++ ){
+  for( uint i = 0; i != _props->npairs; i++ ){
     _orbs[2*i] = crobs[i];
     _orbs[2*i+1] = anobs[i];
   }
@@ -567,7 +616,7 @@ void Matrix::calc_orbtypeshash()
 }
 uint Matrix::diaglevel() const
 {
-  switch ( _type ){
+  switch ( _props->type ){
     case Ops::Exc:
     case Ops::Exc0:
       return 0;
@@ -607,13 +656,13 @@ long int Matrix::iorbel(lui ipos, bool physicist) const
     return ipos1;
   }
   else{
-    if ( _type == Ops::DensM && Input::iPars["prog"]["dmsort"] > 0 )
+    if ( _props->type == Ops::DensM && Input::config.dmsort > 0 )
       // different order of electrons: 1,2,...2, 1
       ipos1 = _orbs.size()-ipos-1;
     else
       ipos1 = ipos%2==0?ipos+1:ipos-1;
 
-    if ( ipos1 >= 2*_npairs )
+    if ( ipos1 >= 2*_props->npairs )
       // one of the non-conserved electrons
       return -1;
     return ipos1;
@@ -639,7 +688,7 @@ Orbital Matrix::orbel(const long int& ipos) const
 
 Matrix::Spinsym Matrix::spinsym(long int ipos) const
 {
-  if (_matspinsym==Triplet && ipos-2 <0) //first electron is triplet
+  if (_props->matspinsym==Triplet && ipos-2 <0) //first electron is triplet
     return Triplet;
   return Singlet;
 }
@@ -647,7 +696,7 @@ SQOpT::Gender Matrix::genderguess(uint ipos) const
 {
   if (_cranorder.size() > 0) return _cranorder[ipos];
   // can't guess for non-conserved electrons, so return a placeholder
-  if (ipos >= 2*_npairs) return SQOpT::Gen;
+  if (ipos >= 2*_props->npairs) return SQOpT::Gen;
   // first creators, second annihilators
   return (ipos%2 == 0)? SQOpT::Creator : SQOpT::Annihilator;
 }
@@ -673,13 +722,13 @@ std::string Matrix::plainname() const
 {
   const std::string& plainsymbols = Input::sPars["syntax"]["plainsymb"];
   std::string plainnam;
-  for ( uint i = 0; i < _name.size(); ++i ){
-    if ( plainsymbols.find(_name[i]) != std::string::npos ){
-      plainnam += _name[i];
+  for ( uint i = 0; i < _props->name.size(); ++i ){
+    if ( plainsymbols.find(_props->name[i]) != std::string::npos ){
+      plainnam += _props->name[i];
     }
   }
   if ( type() == Ops::FluctP || type() == Ops::Fock || _threeelectronint ) {
-    if ( (type() == Ops::Fock && Input::iPars["prog"]["algo"] == 2) || (Input::iPars["prog"]["algo"] == 2 && _threeelectronint) ) return plainnam;
+    if ( (type() == Ops::Fock && Input::config.algo == 2) || (Input::config.algo == 2 && _threeelectronint) ) return plainnam;
     else return integralnames();
   }
   return plainnam;
@@ -687,10 +736,10 @@ std::string Matrix::plainname() const
 
 std::string Matrix::integralnames() const
 {
-  if ( Input::iPars["prog"]["algo"] == 1 ){//ITF code
+  if ( Input::config.algo == 1 ){//ITF code
     return itfintegralnames();
   }
-  else if ( Input::iPars["prog"]["algo"] == 2 ){//ElemCo code
+  else if ( Input::config.algo == 2 ){//ElemCo code
     return elemcointegralnames();
   }
   else{
@@ -701,7 +750,7 @@ std::string Matrix::integralnames() const
 
 std::string Matrix::itfintegralnames() const
 {
-  if (_type == Ops::Fock )
+  if (_props->type == Ops::Fock )
   {
     return itf1eint();
   }
@@ -720,14 +769,14 @@ std::string Matrix::itfintegralnames() const
 
 std::string Matrix::itf1eint() const{
   assert(_orbs.size() == 2);
-  assert(_type == Ops::Fock);
+  assert(_props->type == Ops::Fock);
   if( this->_orbs[0].type() == Orbital::Occ && this->_orbs[1].type() == Orbital::Virt ) return "f21";
   else return "f";
 }
 
 std::string Matrix::itf2eint() const{
   assert(_orbs.size() == 4);
-  assert(_type == Ops::FluctP);
+  assert(_props->type == Ops::FluctP);
   Product<Orbital> orbs = this->orbitals();
   uint virtel1, virtel2;
   virtel1 = virtel2 = 0;
@@ -804,8 +853,8 @@ std::string Matrix::itf3eint() const{
   std::vector<uint> virtelvec = calc_virtelvec(_orbs);
   Product<uint> ref, refref;
   Product<Orbital> orbs = _orbs;
-  ref.identity(_npairs);
-  // for(uint i = 0; i < _npairs; i++){
+  ref.identity(_props->npairs);
+  // for(uint i = 0; i < _props->npairs; i++){
   //   if( _orbs[i*2].type() == Orbital::Virt ) virtelvec[i]++;
   //   if( _orbs[(i*2)+1].type() == Orbital::Virt ) virtelvec[i]++;
   // }
@@ -816,7 +865,7 @@ std::string Matrix::itf3eint() const{
   }
   orbs = orbs.refpro(refref);
   std::fill(virtelvec.begin(), virtelvec.end(), 0);
-  for(uint i = 0; i < _npairs; i++){
+  for(uint i = 0; i < _props->npairs; i++){
     if( orbs[i*2].type() == Orbital::Virt ) virtelvec[i]++;
     if( orbs[(i*2)+1].type() == Orbital::Virt ) virtelvec[i]++;
   }
@@ -854,7 +903,7 @@ std::string Matrix::elemcointegralnames() const
 
 std::string Matrix::elemco2eint() const
 {
-  assert( _type == Ops::FluctP );
+  assert( _props->type == Ops::FluctP );
   std::string name="dummy";
   bool exchange = false;
   for ( uint iorb = 0; iorb < this->orbitals().size(); ++iorb ) {
@@ -973,7 +1022,7 @@ std::string Matrix::elemco2eint() const
 std::ostream & operator << (std::ostream & o, Matrix const & mat)
 {
   short clean = Input::iPars["output"]["clean"];
-  std::string exc0 = Input::sPars["output"]["exc0"];
+  const std::string& exc0 = Input::config.exc0;
   std::string tensor("");
   if ( clean <= 0 ) tensor = "\\"+Input::sPars["command"]["tensor"] + " ";
   switch ( mat.type() ){
@@ -1006,7 +1055,7 @@ std::ostream & operator << (std::ostream & o, Matrix const & mat)
         o << "}";
       } else {
         std::ostringstream oss;
-        bool dmsort = (Input::iPars["prog"]["dmsort"] > 0);
+        bool dmsort = (Input::config.dmsort > 0);
         // occ.indices
         if (dmsort) {
           for ( uint i = 0; i < orbs.size()/2; ++i ){
@@ -20,7 +20,7 @@ namespace Ops {
   Product<Orbital> genprodorb(short exccl,Orbital const & occ, Orbital const & virt);
 }
 
-typedef std::set<long int> TCon2;
+typedef std::pmr::set<long int> TCon2;
 // represents connecting line, i.e. tells to which index in which matrix it is connected
 struct ConLine {
   ConLine() : imat(0),idx(0){};
@@ -61,20 +61,20 @@ class Matrix {
   //and bring excitation operators in the right order
   void elemcoorder();
   // return name
-  std::string name() const;
-  void set_name(const std::string& newname) { _name = newname; };
+  const std::string& name() const { return _props->name; };
+  void set_name(const std::string& newname) { Props p(*_props); p.name = newname; _props = intern(p); };
   // return true if antisymmetrized form
   bool antisymform() const;
   // number of conserved electrons
-  uint npairs() const { return _npairs;};
+  uint npairs() const { return _props->npairs;};
   // non-conserved electrons
-  short lmel() const { return _lmel;};
+  short lmel() const { return _props->lmel;};
   // plus/minus symmetry for index permutations in spin-integrated form
-  short pmsym() const { return _pmsym;};
-  bool has_pmsym() const { return _pmsym != 0; };
+  short pmsym() const { return _props->pmsym;};
+  bool has_pmsym() const { return _props->pmsym != 0; };
   // check if all electrons of Matrix have same spin
   bool samespin() const;
-  Spinsym matspinsym() const { return _matspinsym;};
+  Spinsym matspinsym() const { return _props->matspinsym;};
   // check whether all orbitals are in sumorbs and set _internal variable
   bool is_internal(const TOrbSet& sumorbs);
   // is internal?
@@ -99,8 +99,10 @@ class Matrix {
   bool operator == (Matrix const & t) const;
   // equivalence of two matrices (i.e., without orbital names)
   bool equivalent( const Matrix& mat) const;
+  // hash of the properties compared in equivalent()
+  uint64_t equivkey() const;
   // number of vertices ("electrons") in the matrix
-  uint nvertices() const { return _npairs+(_orbs.size()-2*_npairs);};
+  uint nvertices() const { return _props->npairs+(_orbs.size()-2*_props->npairs);};
   // equivalent vertices (starting from 0+offs to nvertices-1+offs) (indistinguishability of electrons...)
   Equivalents equivertices(uint offs = 0) const;
   // creators orbitals (if anni=true - annihilators orbitals) (in the same order of electrons!)
@@ -137,6 +139,8 @@ class Matrix {
   void set_no_el();
   // reset vertices
   void reset_vertices();
+  // index of the vertices set in vertices() (-1 if not set yet)
+  long int vertindx() const { return _indx; };
   // compare vertices
   bool vertices(long int ipos, Matrix & mat, long int ipos1, unsigned int indx);
   // set connections
@@ -180,27 +184,35 @@ class Matrix {
   bool _threeelectronint;
 
   private:
+  // properties of the matrix which do not depend on the orbitals,
+  // interned and shared between all matrices with the same properties
+  struct Props {
+    Ops::Type type;
+    std::string name;
+    Spinsym matspinsym;
+    bool antisymform; // W is constructed in antisymmetrized form, but can be expanded later.
+    // number of orbital pairs (== electrons for number-conserving operators and otherwise == conserved particles)
+    uint npairs;
+    // non-conserved electrons
+    short lmel;
+    // plus/minus symmetry under index permutations (after spin integration!)
+    // i.e., denotes singlet (=1)/triplet (=-1) combinations. default =0
+    short pmsym;
+    bool operator < (const Props& p) const;
+  };
+  // entry for props (thread-safe)
+  static const Props * intern(const Props& props);
   // generate name from type or use the given name
-  void gen_name(const std::string& name);
+  static std::string gen_name(Ops::Type type, const std::string& name);
   // sets internal variables. it's used by constructors
   void create_Matrix(Ops::Type t, uint npairs, short lmel, short pmsym,
                      std::string name, Spinsym matspinsym, bool antisymW);
-  Ops::Type _type;
+  const Props * _props;
   // orbitals in the electron-order
   Product<Orbital> _orbs;
-  std::string _name;
-  Spinsym _matspinsym;
   Product<SQOpT::Gender> _cranorder; // sets creator or annihilator type for every orbital (for density matrices only!)
-  bool _antisymform; // W is constructed in antisymmetrized form, but can be expanded later.
   // for Exc0 and Deexc0 operators: is it completely internal (i.e., part of \sum_\mu T_\mu \tau_mu) or external
   bool _internal;
-  // number of orbital pairs (== electrons for number-conserving operators and otherwise == conserved particles)
-  uint _npairs;
-  // non-conserved electrons
-  short _lmel;
-  // plus/minus symmetry under index permutations (after spin integration!)
-  // i.e., denotes singlet (=1)/triplet (=-1) combinations. default =0
-  short _pmsym;
   // needed for comparison of terms:
   long int _indx;
   // connected to (index of matrix in term (start from 1!!!)):
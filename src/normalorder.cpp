@@ -0,0 +1,92 @@
+#include "normalorder.h"
+
+thread_local NormalOrderer::Cache NormalOrderer::_cache;
+
+const std::vector<NOPattern>& NormalOrderer::patterns(const Product<SQOp>& ops, bool ph, bool fullyContractedOnly)
+{
+  if ( ops.size() > maxops ) error("Too many SQ operators for normal ordering","NormalOrderer");
+  // layout of the string: gender, PH-gender and orbital type of each SQop
+  std::string layout(1,char(ph) | char(fullyContractedOnly) << 1);
+  layout.reserve(ops.size()+1);
+  for ( const auto& sqop: ops )
+    layout.push_back(char(sqop.gender() | sqop.genderPH() << 2 | sqop.orb().type() << 4));
+  auto it = _cache.find(layout);
+  if ( it != _cache.end() ) return it->second;
+  NormalOrderer no(ops,ph,fullyContractedOnly);
+  NOPattern pat;
+  pat.sign = 1;
+  pat.orig = true;
+  for ( uint i = 0; i < ops.size(); ++i )
+    pat.ops.push_back(i);
+  if ( ph )
+    no.reorderPH(pat);
+  else
+    no.reorder(pat);
+  std::vector<NOPattern>& pats = _cache[layout];
+  pats.swap(no._patterns);
+  return pats;
+}
+
+void NormalOrderer::reorder(const NOPattern& curr)
+{
+  for ( unsigned int i=0 ; i+1<curr.ops.size() ; ++i ) {
+    // check if two consecutive operators need reordering
+    if ( op(curr.ops[i]).gender()==SQOpT::Annihilator && op(curr.ops[i+1]).gender()==SQOpT::Creator ) {
+      // handle 1st term
+      NOPattern p(curr);
+      p.orig = false;
+      std::swap(p.ops[i], p.ops[i+1]);
+      p.sign = -curr.sign;
+      if ( !_fullyContractedOnly || op(p.ops.back()).gender()==SQOpT::Creator )
+        reorder(p);
+      // handle 2nd term
+      NOPattern q(p);
+      q.sign = curr.sign;
+      q.ops.erase(q.ops.begin()+i,q.ops.begin()+i+2);
+      q.krons.push_back(p.ops[i]);
+      q.krons.push_back(p.ops[i+1]);
+      if ( !_fullyContractedOnly || q.ops.size()==0 || op(q.ops.back()).gender()==SQOpT::Creator )
+        reorder(q);
+      return;
+    }
+  }
+  _patterns.push_back(curr);
+}
+
+void NormalOrderer::reorderPH(const NOPattern& curr)
+{
+  for ( unsigned int i=0 ; i+1<curr.ops.size() ; ++i ) {
+    const SQOp &opi = op(curr.ops[i]), &opi1 = op(curr.ops[i+1]);
+    // check if two consecutive operators need reordering
+    bool creat2 = (( opi.genderPH()==SQOpT::Annihilator || opi.genderPH()==SQOpT::Gen )
+                     && opi1.genderPH()==SQOpT::Creator );
+    bool annih1 = ( opi.genderPH()==SQOpT::Annihilator
+                     && ( opi1.genderPH()==SQOpT::Creator || opi1.genderPH()==SQOpT::Gen ));
+    if ( creat2 || annih1 ) {
+      // handle 1st term
+      NOPattern p(curr);
+      p.orig = false;
+      std::swap(p.ops[i], p.ops[i+1]);
+      p.sign = -curr.sign;
+      if ( !_fullyContractedOnly || op(p.ops.back()).genderPH()==SQOpT::Creator
+              || op(p.ops.front()).genderPH()==SQOpT::Annihilator )
+        reorderPH(p);
+      if ( opi.orb().type()==opi1.orb().type() ||
+           ( ( opi.orb().type()==Orbital::GenT || opi1.orb().type()==Orbital::GenT )
+             && opi.gender()!=opi1.gender() )) {
+        // handle 2nd term
+        NOPattern q(p);
+        q.sign = curr.sign;
+        q.ops.erase(q.ops.begin()+i,q.ops.begin()+i+2);
+        q.krons.push_back(p.ops[i]);
+        q.krons.push_back(p.ops[i+1]);
+        if ( !_fullyContractedOnly || q.ops.size()==0 || op(q.ops.back()).genderPH()==SQOpT::Creator
+                || op(q.ops.front()).genderPH()==SQOpT::Annihilator )
+          reorderPH(q);
+      }
+      return;
+    }
+  }
+  if ( !_fullyContractedOnly || curr.ops.size()==0 )
+    _patterns.push_back(curr);
+}
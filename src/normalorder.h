@@ -0,0 +1,54 @@
+#ifndef NORMALORDER_H
+#define NORMALORDER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "globals.h"
+#include "operators.h"
+
+/*!
+    Implements normal ordering of a string of second quantized operators
+    by swapping neighbouring operators (the anticommutators give Kroneckers).
+
+    The result depends only on the genders and orbital types of the SQops,
+    hence the signed patterns are generated once for each layout of the string
+    and instantiated for all strings with the same layout.
+*/
+
+//! one term of the normal ordered string (indices in the original string)
+struct NOPattern {
+  // sign of the term (+1 or -1)
+  int sign;
+  // the original string (no reordering was needed)
+  bool orig;
+  // SQops of the normal ordered string
+  std::vector<unsigned char> ops;
+  // Kronecker pairs (krons[2i],krons[2i+1])
+  std::vector<unsigned char> krons;
+};
+
+class NormalOrderer {
+public:
+  //! max number of SQops in the operator string
+  static const uint maxops = 255;
+  //! normal ordered patterns for the operator string
+  //! ph: particle/hole formalism, fullyContractedOnly: keep only terms which can be fully contracted
+  static const std::vector<NOPattern>& patterns(const Product<SQOp>& ops, bool ph, bool fullyContractedOnly);
+private:
+  NormalOrderer(const Product<SQOp>& ops, bool ph, bool fullyContractedOnly)
+    : _ops(ops), _ph(ph), _fullyContractedOnly(fullyContractedOnly) {};
+  // reorder recursively (as in Term::normalOrder and Term::normalOrderPH)
+  void reorder(const NOPattern& curr);
+  void reorderPH(const NOPattern& curr);
+  // SQop in the original string
+  const SQOp& op(unsigned char i) const { return _ops[i]; };
+  const Product<SQOp>& _ops;
+  bool _ph, _fullyContractedOnly;
+  std::vector<NOPattern> _patterns;
+  // patterns for each layout of the string (one per thread)
+  typedef std::unordered_map< std::string, std::vector<NOPattern> > Cache;
+  static thread_local Cache _cache;
+};
+
+#endif
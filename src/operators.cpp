@@ -1,4 +1,5 @@
 #include "operators.h"
+#include "term.h"
 
 /* SQOp::SQOp(std::string orb)
 {
@@ -138,11 +139,11 @@ Oper::Oper(Ops::Type type, short int exccl, const std::vector<OrbitalTypes>& orb
       }
     }
   } else {
-    TsPar& orbs = Input::sPars["syntax"];
-    orbnames[Orbital::Occ] = Orbital(std::string(1,char(std::toupper(orbs["occorb"][0]))));
-    orbnames[Orbital::Virt] = Orbital(std::string(1,char(std::toupper(orbs["virorb"][0]))));
-    orbnames[Orbital::Act] = Orbital(std::string(1,char(std::toupper(orbs["actorb"][0]))));
-    orbnames[Orbital::GenT] = Orbital(std::string(1,char(std::toupper(orbs["genorb"][0]))));
+    const Input::Config& conf = Input::config;
+    orbnames[Orbital::Occ] = Orbital(std::string(1,char(std::toupper(conf.occorb[0]))));
+    orbnames[Orbital::Virt] = Orbital(std::string(1,char(std::toupper(conf.virorb[0]))));
+    orbnames[Orbital::Act] = Orbital(std::string(1,char(std::toupper(conf.actorb[0]))));
+    orbnames[Orbital::GenT] = Orbital(std::string(1,char(std::toupper(conf.genorb[0]))));
   }
   create_Oper(exccl,orbnames,orbtypes,name,lm,pmsym);
 }
@@ -222,7 +223,7 @@ void Oper::create_Oper(const std::string& name, bool antisym, const std::vector<
   short npairs = porbs.size()/2;
   _mat=Matrix(_type,porbs,npairs,0,0,name,spinsym,antisym);
   // needed for expanding general normal ordered operators later
-  if ( Input::iPars["prog"]["contrexcop"] > 1 ) move_SQprod();
+  if ( Input::config.contrexcop > 1 ) move_SQprod();
 }
 void Oper::create_Oper(short int const & exccl,Orbital const & occ, Orbital const & virt,
                        std::string const & name, int lm, int pmsym)
@@ -334,9 +335,9 @@ void Oper::create_Oper(const Product< Orbital >& occs, const Product< Orbital >&
 void Oper::create_Oper(const Product< Orbital >& orbs, const std::string& name, int lm, int pmsym)
 {
   assert( !InSet(_type, Ops::FluctP,Ops::Fock,Ops::OneEl,Ops::XPert) );
-  bool spinintegr = Input::iPars["prog"]["spinintegr"];
-  bool noprefac = (Input::iPars["prog"]["nobrafac"]) && InSet(_type, Ops::Exc0,Ops::Deexc0);
-  int contrexcop = Input::iPars["prog"]["contrexcop"];
+  bool spinintegr = Input::config.spinintegr;
+  bool noprefac = (Input::config.nobrafac) && InSet(_type, Ops::Exc0,Ops::Deexc0);
+  int contrexcop = Input::config.contrexcop;
   Matrix::Spinsym spinsym = Matrix::Singlet;
   Product<SQOp> anniSQprod;
   // excitation and deexcitation operators
@@ -517,6 +518,8 @@ Matrix Oper::mat() const
 { return _mat;}
 Product< SQOp > Oper::SQprod() const
 { return _SQprod;}
+TermSum Oper::sumops() const
+{ return _sumops;}
 TFactor Oper::prefac() const
 { return _prefac;}
 const TOrbSet & Oper::orbs() const
@@ -12,7 +12,7 @@
 #include "orbital.h"
 #include "matrix.h"
 #include "product.h"
-#include "term.h"
+#include "sum.h"
 #include "assert.h"
 
 /*!
@@ -90,7 +90,7 @@ class Oper {
   //return operator
   Product<SQOp> SQprod() const;
   //return sum of operators/matrices - for the generalized normal ordering
-  TermSum sumops() const { return _sumops; }
+  TermSum sumops() const;
   //return prefactor
   TFactor prefac() const;
   // return orbitals
@@ -1,123 +1,166 @@
 #include "orbital.h"
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+
+OrbitalName::OrbitalName(const std::string& name)
+ : _str(name), _prefix(0)
+{
+  for ( uint i = 0; i < 8; ++i ) {
+    _prefix <<= 8;
+    if ( i < name.size() ) _prefix |= (unsigned char)name[i];
+  }
+}
+
+const OrbitalName * OrbitalName::intern(const std::string& name)
+{
+  static std::mutex mtx;
+  static std::unordered_map< std::string, std::unique_ptr<OrbitalName> > names;
+  std::lock_guard<std::mutex> lock(mtx);
+  std::unique_ptr<OrbitalName>& entry = names[name];
+  if ( !entry ) entry.reset(new OrbitalName(name));
+  return entry.get();
+}
+
+const OrbitalName * OrbitalName::empty()
+{
+  static const OrbitalName * emptyname = intern("");
+  return emptyname;
+}
 
 Orbital::Orbital()
+ : _code(0), _name(OrbitalName::empty())
 {
-  _type = Orbital::NoType;
-  _spin = Spin(Spin::No);
+  settype(Orbital::NoType);
+  setspin(Spin(Spin::No));
 }
 
 Orbital::Orbital(const std::string& name, Electron el)
+ : _code(0)
 {
-  bool spinintegr = Input::iPars["prog"]["spinintegr"];
+  bool spinintegr = Input::config.spinintegr;
   Spin::Type spintype = Spin::Gen;
   if (spinintegr) spintype = Spin::GenS;
   if ( isupper((char)name[0]) )
-    _spin = Spin(el, spintype);
+    setspin(Spin(el, spintype));
   else
-    _spin = Spin(Spin::No);
-  _name=name;
-  _name[0] = std::tolower(name[0]);
-  gentype();
+    setspin(Spin(Spin::No));
+  setname(name);
+  gentype(this->name());
 
 }
 
 Orbital::Orbital(const std::string& name, Orbital::Type type, Electron el)
+ : _code(0)
 {
-  bool spinintegr = Input::iPars["prog"]["spinintegr"];
+  bool spinintegr = Input::config.spinintegr;
   Spin::Type spintype = Spin::Gen;
   if (spinintegr) spintype = Spin::GenS;
   if ( isupper((char)name[0]) )
-    _spin = Spin(el, spintype);
+    setspin(Spin(el, spintype));
   else
-    _spin = Spin(Spin::No);
-  _name=name;
-  _name[0] = std::tolower(name[0]);
-  _type=type;
+    setspin(Spin(Spin::No));
+  setname(name);
+  settype(type);
 }
 
 Orbital::Orbital(const std::string& name, Spin spin)
+ : _code(0)
 {
-  _spin=spin;
-  _name=name;
-  _name[0] = std::tolower(name[0]);
-  gentype();
+  setspin(spin);
+  setname(name);
+  gentype(this->name());
 }
 Orbital::Orbital(const std::string& name, Spin::Type spint, Electron el)
+ : _code(0)
 {
-  _spin = Spin(el,spint);
-  _name=name;
-  _name[0] = std::tolower(name[0]);
-  gentype();
+  setspin(Spin(el,spint));
+  setname(name);
+  gentype(this->name());
 }
 Orbital::Orbital(const std::string& name, Orbital::Type type, Spin spin)
+ : _code(0)
 {
-  _spin=spin;
-  _type=type;
-  _name=name;
-  _name[0] = std::tolower(name[0]);
+  setspin(spin);
+  settype(type);
+  setname(name);
 }
 Orbital::Orbital(const std::string& name, Orbital::Type type, Spin::Type spint, Electron el)
+ : _code(0)
 {
-  _spin = Spin(el,spint);
-  _type=type;
-  _name=name;
-  _name[0] = std::tolower(name[0]);
+  setspin(Spin(el,spint));
+  settype(type);
+  setname(name);
 }
 Orbital::Orbital(Orbital::Type type)
+ : _code(0), _name(OrbitalName::empty())
 {
-  TsPar& orbs = Input::sPars["syntax"];
-  _spin = Spin(Spin::No);
-  _type = type;
+  const Input::Config& conf = Input::config;
+  setspin(Spin(Spin::No));
+  settype(type);
   switch( type ){
     case Occ:
-      _name = orbs["occorb"][0];
+      _name = OrbitalName::intern(std::string(1,conf.occorb[0]));
       break;
     case Virt:
-      _name = orbs["virorb"][0];
+      _name = OrbitalName::intern(std::string(1,conf.virorb[0]));
       break;
     case GenT:
-      _name = orbs["genorb"][0];
+      _name = OrbitalName::intern(std::string(1,conf.genorb[0]));
       break;
     case Act:
-      _name = orbs["actorb"][0];
+      _name = OrbitalName::intern(std::string(1,conf.actorb[0]));
       break;
     default:
       Error("Unknown type of orbital!");
   }
 }
 
+void Orbital::setname(const std::string& name)
+{
+  if ( !name.empty() && std::isupper((unsigned char)name[0]) ) {
+    std::string lname(name);
+    lname[0] = std::tolower(name[0]);
+    _name = OrbitalName::intern(lname);
+  } else
+    _name = OrbitalName::intern(name);
+}
 
-void Orbital::gentype()
+void Orbital::gentype(const std::string& name)
 {
-  TsPar& orbs = Input::sPars["syntax"];
-  if (orbs["virorb"].find(_name[0])!=std::string::npos) {_type=Virt;}
-  else if (orbs["occorb"].find(_name[0])!=std::string::npos) {_type=Occ;}
-  else if (orbs["genorb"].find(_name[0])!=std::string::npos) {_type=GenT;}
-  else if (orbs["actorb"].find(_name[0])!=std::string::npos) {_type=Act;}
+  const Input::Config& conf = Input::config;
+  if (conf.virorb.find(name[0])!=std::string::npos) {settype(Virt);}
+  else if (conf.occorb.find(name[0])!=std::string::npos) {settype(Occ);}
+  else if (conf.genorb.find(name[0])!=std::string::npos) {settype(GenT);}
+  else if (conf.actorb.find(name[0])!=std::string::npos) {settype(Act);}
   else
-    error("Unknown type of orbital! "+_name,"Orbital::gentype");
+    error("Unknown type of orbital! "+name,"Orbital::gentype");
 }
 
 std::string Orbital::letname() const
 {
+  const std::string& name = this->name();
   lui iend;
-  for ( iend = this->_name.size(); iend > 0 && isdigit(this->_name[iend-1]); --iend ){}
-  return _name.substr(0,iend);
+  for ( iend = name.size(); iend > 0 && isdigit(name[iend-1]); --iend ){}
+  return name.substr(0,iend);
 }
 void Orbital::replace_letname(const std::string& newname)
 {
+  std::string name(this->name());
   lui iend;
-  for ( iend = this->_name.size(); iend > 0 && isdigit(this->_name[iend-1]); --iend ){}
-  _name.replace(0,iend,newname);
+  for ( iend = name.size(); iend > 0 && isdigit(name[iend-1]); --iend ){}
+  name.replace(0,iend,newname);
+  _name = OrbitalName::intern(name);
 }
 void Orbital::add_prime()
 {
   std::string orbname, up, down;
-  IL::nameupdown(orbname,up,down,_name);
+  IL::nameupdown(orbname,up,down,name());
   up += "\\prime";
-  _name = orbname;
-  if (!down.empty()) _name += "_{"+down+"}";
-  _name += "^{"+up+"}";
+  std::string name(orbname);
+  if (!down.empty()) name += "_{"+down+"}";
+  name += "^{"+up+"}";
+  _name = OrbitalName::intern(name);
 }
 
 int Orbital::comp_letname(const Orbital& orb) const
@@ -146,23 +189,26 @@ Return Orbital::replace(const Orbital& orb1, const Orbital& orb2, bool smart)
     *this = orb2;
     if (smart) {
       // restore spin -- will be replaced explicitely
-      this->_spin = orb1._spin;
+      this->setspin(orb1.spin());
     }
   }
   if (smart)
-    return this->_spin.replace(orb1._spin,orb2._spin);
+    return this->replace(orb1.spin(),orb2.spin(),smart);
   else
     return Return::Done;
 }
 Return Orbital::replace(const Spin& spin1, const Spin& spin2, bool smart)
 {
   (void)smart; //unused variable
-  return this->_spin.replace(spin1,spin2);
+  Spin spin(this->spin());
+  Return rpl = spin.replace(spin1,spin2);
+  this->setspin(spin);
+  return rpl;
 }
 
 std::ostream & operator << (std::ostream & o, TOrbSet const & orbset)
 {
-  bool explspin = Input::iPars["prog"]["explspin"];
+  bool explspin = Input::config.explspin;
   for( auto it : orbset ){
     if (explspin) o << "{";
     o << it;
@@ -278,7 +324,7 @@ std::ostream& operator<<(std::ostream& o, const Spin& spin)
 OrbitalTypes::OrbitalTypes(const std::string& types, bool occ)
 {
   if ( types.empty() ) return;
-  bool spinintegr = Input::iPars["prog"]["spinintegr"];
+  bool spinintegr = Input::config.spinintegr;
   Spin::Type spintype = Spin::Gen;
   if (spinintegr) spintype = Spin::GenS;
   lui ipos, ipos1;
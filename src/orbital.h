@@ -3,6 +3,7 @@
 
 #include <string>
 #include <iostream>
+#include <stdint.h>
 #include <assert.h>
 #include "utilities.h"
 #include "globals.h"
@@ -51,6 +52,29 @@ private:
 
 std::ostream & operator << (std::ostream & o, const Spin& spin);
 
+/*
+    Interned orbital names: equal names share one entry, which lives until the end of the program
+*/
+class OrbitalName {
+  public:
+  // entry for name (thread-safe)
+  static const OrbitalName * intern(const std::string& name);
+  // entry for the empty name
+  static const OrbitalName * empty();
+  const std::string& str() const { return _str; };
+  // lexicographical ordering of the names
+  bool less(const OrbitalName& on) const
+    {
+      if ( _prefix != on._prefix ) return _prefix < on._prefix;
+      return _str < on._str;
+    };
+  explicit OrbitalName(const std::string& name);
+  private:
+  std::string _str;
+  // first 8 characters (big endian), decides the ordering of short names
+  uint64_t _prefix;
+};
+
 class Orbital;
 class Electrons;
 typedef Set<Orbital> TOrbSet;
@@ -87,33 +111,38 @@ class Orbital {
   // constructor from type (for printing of types)
   Orbital ( Type type );
   // return orbital
-  std::string name() const {return _name;};
-  Type type() const {return _type;};
-  Spin spin() const {return _spin;};
+  const std::string& name() const {return _name->str();};
+  Type type() const {return Type(_code >> typeshift);};
+  Spin spin() const
+    {
+      Spin spin(Spin::Type(_code & spinmask));
+      spin.setel(getel());
+      return spin;
+    };
   // set spin
-  void setspin(Spin spin) { _spin=spin; };
-  // set electron (in _spin)
-  void setel(Electron el){_spin.setel(el);};
-  // get electron (from _spin)
-  Electron getel() const {return _spin.el();};
+  void setspin(Spin spin)
+    { _code = (_code & typemask) | (uint64_t(spin.el()) << elshift) | uint64_t(spin.type()); };
+  // set electron (in spin)
+  void setel(Electron el)
+    { _code = (_code & ~elmask) | (uint64_t(el) << elshift); };
+  // get electron (from spin)
+  Electron getel() const {return Electron((_code & elmask) >> elshift);};
   // check equality
   bool operator == (Orbital const & orb) const
-       { return _spin==orb._spin && _type==orb._type && _name==orb._name;};
+       { return _code==orb._code && _name==orb._name;};
   // check inequality
   bool operator != (Orbital const & orb) const { return !(*this==orb); };
   // check ordering relation (for sorting)
   bool operator < (Orbital const & orb) const
     {
-      if (_type<orb._type) return true;
-      if (orb._type<_type) return false;
-      if (_name<orb._name) return true;
-      if (_name>orb._name) return false;
-//    assert( _type == orb._type );
-      return _spin<orb._spin;
+      // orbital type, name, electron and spin type
+      if ( (_code ^ orb._code) & typemask ) return _code < orb._code;
+      if ( _name != orb._name ) return _name->less(*orb._name);
+      return _code < orb._code;
     };
   // check equality without checking electrons
   bool equal(const Orbital& orb) const
-    { return _spin.equal(orb._spin) && _type==orb._type && _name==orb._name; };
+    { return ((_code ^ orb._code) & ~elmask) == 0 && _name==orb._name; };
   // return letter-name of orbital
   std::string letname() const;
   void replace_letname(const std::string& newname);
@@ -130,11 +159,18 @@ class Orbital {
   Return replace( const Spin& spin1, const Spin& spin2, bool smart);
 
   private:
-  // generate orbital type from _name
-  void gentype();
-  Type _type;
-  Spin _spin;
-  std::string _name;
+  // generate orbital type from name
+  void gentype(const std::string& name);
+  void settype(Type type)
+    { _code = (_code & ~typemask) | (uint64_t(type) << typeshift); };
+  // set the (interned) name, the first letter is always lower case
+  void setname(const std::string& name);
+  // orbital type, electron and spin type packed in one word
+  // (the ordering of the codes corresponds to the ordering of the orbitals for equal names)
+  static const uint elshift = 8, typeshift = 40;
+  static const uint64_t spinmask = 0xFF, elmask = 0xFFFFFFFFull << elshift, typemask = ~0ull << typeshift;
+  uint64_t _code;
+  const OrbitalName * _name;
 };
 
 std::ostream & operator << (std::ostream & o, Orbital const & orb);
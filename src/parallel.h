@@ -0,0 +1,46 @@
+#ifndef Parallel_H
+#define Parallel_H
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+/*!
+    Implements a simple thread pool for independent work items
+*/
+
+namespace Parallel {
+  //! number of threads to use for a requested number (0: all available cores)
+  inline unsigned int nthreads(long int requested)
+  {
+    if ( requested > 0 ) return requested;
+    unsigned int nhw = std::thread::hardware_concurrency();
+    return std::max(nhw,1u);
+  }
+  //! call func(i) for i = 0..n-1 using nthr threads
+  /*! the work items are handed out dynamically (next free item), such that
+   *  threads that got cheap items pick up the remaining ones.
+   *  func has to be thread-safe, the order of calls is not defined */
+  template <class F>
+  void for_each(std::size_t n, unsigned int nthr, F func)
+  {
+    nthr = std::min<std::size_t>(nthr,n);
+    if ( nthr <= 1 ) {
+      for ( std::size_t i = 0; i < n; ++i ) func(i);
+      return;
+    }
+    std::atomic<std::size_t> next(0);
+    auto worker = [&](){
+      for ( std::size_t i = next++; i < n; i = next++ ) func(i);
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(nthr-1);
+    for ( unsigned int it = 1; it < nthr; ++it )
+      threads.emplace_back(worker);
+    worker();
+    for ( auto& th: threads ) th.join();
+  }
+}
+
+#endif
@@ -50,7 +50,7 @@ template <class T>
 inline
 std::ostream & operator << (std::ostream & o, Product<T> const & p)
 {
-  bool explspin = Input::iPars["prog"]["explspin"];
+  bool explspin = Input::config.explspin;
   for ( typename Product<T>::const_iterator i=p.begin(); i!=p.end(); ++i ){
     if (explspin) o << "{";
     o << *i;
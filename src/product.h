@@ -3,34 +3,278 @@
 #include <vector>
 #include <list>
 #include <set>
+#include <memory_resource>
 #include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <memory>
+#include <iterator>
+#include <utility>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
 #include "utilities.h"
 
 
+/*
+    Implements a vector which keeps up to N elements in place (no heap allocation)
+*/
+template <class T, std::size_t N>
+class SmallVector {
+  public:
+    typedef T value_type;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T* iterator;
+    typedef const T* const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+    SmallVector() : _begin(inplace()), _size(0), _cap(N) {};
+    explicit SmallVector( size_type n ) : SmallVector() { resize(n); };
+    SmallVector( size_type n, const T& t ) : SmallVector() { resize(n,t); };
+    template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+    SmallVector( InputIt first, InputIt last ) : SmallVector() { append(first,last); }
+    SmallVector( std::initializer_list<T> il ) : SmallVector() { append(il.begin(),il.end()); };
+    SmallVector( const SmallVector& v ) : SmallVector() { append(v.begin(),v.end()); };
+    SmallVector( SmallVector&& v ) noexcept(std::is_nothrow_move_constructible<T>::value) : SmallVector() { take(v); };
+    ~SmallVector() { clear(); release(); };
+    SmallVector& operator = ( const SmallVector& v )
+      {
+        if ( this != &v ) {
+          // assign to the existing elements (reuses their storage, as std::vector does)
+          if ( v._size <= _size ) {
+            std::destroy(std::copy(v.begin(),v.end(),_begin),end());
+            _size = v._size;
+          } else {
+            reserve(v._size);
+            std::copy(v.begin(),v.begin()+_size,_begin);
+            std::uninitialized_copy(v.begin()+_size,v.end(),_begin+_size);
+            _size = v._size;
+          }
+        }
+        return *this;
+      };
+    SmallVector& operator = ( SmallVector&& v ) noexcept(std::is_nothrow_move_constructible<T>::value)
+      {
+        if ( this != &v ) {
+          clear();
+          take(v);
+        }
+        return *this;
+      };
+
+    iterator begin() { return _begin; };
+    const_iterator begin() const { return _begin; };
+    const_iterator cbegin() const { return _begin; };
+    iterator end() { return _begin+_size; };
+    const_iterator end() const { return _begin+_size; };
+    const_iterator cend() const { return _begin+_size; };
+    reverse_iterator rbegin() { return reverse_iterator(end()); };
+    const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); };
+    reverse_iterator rend() { return reverse_iterator(begin()); };
+    const_reverse_iterator rend() const { return const_reverse_iterator(begin()); };
+
+    size_type size() const { return _size; };
+    bool empty() const { return _size == 0; };
+    size_type capacity() const { return _cap; };
+    T * data() { return _begin; };
+    const T * data() const { return _begin; };
+    reference operator[]( size_type i ) { return _begin[i]; };
+    const_reference operator[]( size_type i ) const { return _begin[i]; };
+    reference at( size_type i )
+      { if ( i >= _size ) throw std::out_of_range("SmallVector::at"); return _begin[i]; };
+    const_reference at( size_type i ) const
+      { if ( i >= _size ) throw std::out_of_range("SmallVector::at"); return _begin[i]; };
+    reference front() { return _begin[0]; };
+    const_reference front() const { return _begin[0]; };
+    reference back() { return _begin[_size-1]; };
+    const_reference back() const { return _begin[_size-1]; };
+
+    void reserve( size_type n ) { if ( n > _cap ) grow(n); };
+    void clear() { std::destroy(_begin,_begin+_size); _size = 0; };
+    void push_back( const T& t )
+      {
+        if ( _size == _cap ) {
+          T tt(t); // t may be an element of this vector
+          grow(_size+1);
+          new (_begin+_size) T(std::move(tt));
+        } else
+          new (_begin+_size) T(t);
+        ++_size;
+      };
+    void push_back( T&& t ) { emplace_back(std::move(t)); };
+    template <class... Args>
+    reference emplace_back( Args&&... args )
+      {
+        if ( _size == _cap ) {
+          T tt(std::forward<Args>(args)...);
+          grow(_size+1);
+          new (_begin+_size) T(std::move(tt));
+        } else
+          new (_begin+_size) T(std::forward<Args>(args)...);
+        return _begin[_size++];
+      }
+    void pop_back() { --_size; std::destroy_at(_begin+_size); };
+    void resize( size_type n )
+      {
+        if ( n < _size ) {
+          std::destroy(_begin+n,_begin+_size);
+        } else {
+          reserve(n);
+          std::uninitialized_value_construct(_begin+_size,_begin+n);
+        }
+        _size = n;
+      };
+    void resize( size_type n, const T& t )
+      {
+        if ( n < _size ) {
+          std::destroy(_begin+n,_begin+_size);
+          _size = n;
+        } else {
+          T tt(t);
+          reserve(n);
+          std::uninitialized_fill(_begin+_size,_begin+n,tt);
+          _size = n;
+        }
+      };
+    iterator insert( const_iterator pos, const T& t ) { return insert(pos,&t,&t+1); };
+    iterator insert( const_iterator pos, T&& t )
+      {
+        size_type ipos = pos-_begin;
+        emplace_back(std::move(t));
+        std::rotate(_begin+ipos,_begin+_size-1,_begin+_size);
+        return _begin+ipos;
+      };
+    iterator insert( const_iterator pos, size_type n, const T& t )
+      {
+        SmallVector tmp(n,t);
+        return insert(pos,std::make_move_iterator(tmp.begin()),std::make_move_iterator(tmp.end()));
+      };
+    template <class InputIt, class = typename std::iterator_traits<InputIt>::iterator_category>
+    iterator insert( const_iterator pos, InputIt first, InputIt last )
+      {
+        size_type ipos = pos-_begin, oldsize = _size;
+        // the range may point into this vector: append a copy first
+        SmallVector tmp(first,last);
+        reserve(_size+tmp.size());
+        std::uninitialized_move(tmp.begin(),tmp.end(),_begin+_size);
+        _size += tmp.size();
+        std::rotate(_begin+ipos,_begin+oldsize,_begin+_size);
+        return _begin+ipos;
+      }
+    iterator insert( const_iterator pos, std::initializer_list<T> il ) { return insert(pos,il.begin(),il.end()); };
+    iterator erase( const_iterator pos ) { return erase(pos,pos+1); };
+    iterator erase( const_iterator first, const_iterator last )
+      {
+        iterator f = _begin+(first-_begin), l = _begin+(last-_begin);
+        if ( f != l ) {
+          iterator newend = std::move(l,end(),f);
+          std::destroy(newend,end());
+          _size = newend-_begin;
+        }
+        return f;
+      };
+    void swap( SmallVector& v )
+      {
+        SmallVector tmp(std::move(v));
+        v = std::move(*this);
+        *this = std::move(tmp);
+      };
+  private:
+    T * inplace() { return reinterpret_cast<T*>(_buf); };
+    bool isinplace() const { return _begin == reinterpret_cast<const T*>(_buf); };
+    template <class InputIt>
+    void append( InputIt first, InputIt last )
+      {
+        if ( std::is_base_of<std::forward_iterator_tag,
+                             typename std::iterator_traits<InputIt>::iterator_category>::value )
+          reserve(_size+std::distance(first,last));
+        for ( ; first != last; ++first ) emplace_back(*first);
+      }
+    // take the elements of v (v is empty afterwards)
+    void take( SmallVector& v )
+      {
+        if ( v.isinplace() ) {
+          reserve(v._size);
+          std::uninitialized_move(v.begin(),v.end(),_begin);
+          _size = v._size;
+          v.clear();
+        } else {
+          release();
+          _begin = v._begin;
+          _size = v._size;
+          _cap = v._cap;
+          v._begin = v.inplace();
+          v._size = 0;
+          v._cap = N;
+        }
+      };
+    // move the elements to heap storage for at least n elements
+    void grow( size_type n )
+      {
+        size_type cap = std::max<size_type>(std::max<size_type>(2*_cap,n),4);
+        T * mem = static_cast<T*>(::operator new(cap*sizeof(T)));
+        std::uninitialized_move(_begin,_begin+_size,mem);
+        std::destroy(_begin,_begin+_size);
+        release();
+        _begin = mem;
+        _cap = cap;
+      };
+    // free heap storage
+    void release() { if ( !isinplace() ) ::operator delete(_begin); _begin = inplace(); _cap = N; };
+    T * _begin;
+    size_type _size, _cap;
+    alignas(T) unsigned char _buf[N > 0 ? N*sizeof(T) : 1];
+};
+template <class T, std::size_t N>
+inline bool operator == ( const SmallVector<T,N>& a, const SmallVector<T,N>& b )
+  { return a.size() == b.size() && std::equal(a.begin(),a.end(),b.begin()); }
+template <class T, std::size_t N>
+inline bool operator != ( const SmallVector<T,N>& a, const SmallVector<T,N>& b ) { return !(a == b); }
+template <class T, std::size_t N>
+inline bool operator < ( const SmallVector<T,N>& a, const SmallVector<T,N>& b )
+  { return std::lexicographical_compare(a.begin(),a.end(),b.begin(),b.end()); }
+template <class T, std::size_t N>
+inline bool operator > ( const SmallVector<T,N>& a, const SmallVector<T,N>& b ) { return b < a; }
+template <class T, std::size_t N>
+inline bool operator <= ( const SmallVector<T,N>& a, const SmallVector<T,N>& b ) { return !(b < a); }
+template <class T, std::size_t N>
+inline bool operator >= ( const SmallVector<T,N>& a, const SmallVector<T,N>& b ) { return !(a < b); }
+
+// number of elements kept in place in a Product (about 192 bytes, at most 12 elements)
+template <class T>
+struct ProductInplace {
+  static const std::size_t value = ( sizeof(T) > 48 ? 0 : std::min<std::size_t>(12,192/sizeof(T)) );
+};
+
 /*
     Implements a non-commutative product of Ts  (M. Hanrath)
 */
 template <class T>
-class Product : public std::vector<T> {
+class Product : public SmallVector<T,ProductInplace<T>::value> {
+    typedef SmallVector<T,ProductInplace<T>::value> Base;
   public:
-    Product<T> () : std::vector<T>(){};
+    Product<T> () : Base(){};
     Product<T> ( typename Product<T>::const_iterator beg, typename Product<T>::const_iterator end)
-     : std::vector<T>(beg,end){};
-    Product<T> ( const T& a1 ) : std::vector<T>(){
+     : Base(beg,end){};
+    Product<T> ( const T& a1 ) : Base(){
       this->push_back(a1);
     }
-    Product<T> ( const T& a1, const T& a2 ) : std::vector<T>(){
+    Product<T> ( const T& a1, const T& a2 ) : Base(){
       this->push_back(a1);
       this->push_back(a2);
     }
-    Product<T> ( const T& a1, const T& a2, const T& a3 ) : std::vector<T>(){
+    Product<T> ( const T& a1, const T& a2, const T& a3 ) : Base(){
       this->push_back(a1);
       this->push_back(a2);
       this->push_back(a3);
     }
-    Product<T> ( const T& a1, const T& a2, const T& a3, const T& a4 ) : std::vector<T>(){
+    Product<T> ( const T& a1, const T& a2, const T& a3, const T& a4 ) : Base(){
       this->push_back(a1);
       this->push_back(a2);
       this->push_back(a3);
@@ -90,15 +334,16 @@ std::ostream & operator << (std::ostream & o, List<T> const & p);
 
 /*
     Implements a set of Ts (commutative and unique)
+    The nodes are allocated from the default memory resource (see Arena)
 */
 template <class T>
-class Set : public std::set<T> {
+class Set : public std::pmr::set<T> {
   public:
-    Set<T> () : std::set<T>(){};
+    Set<T> () : std::pmr::set<T>(){};
     Set<T> ( typename Set<T>::const_iterator beg, typename Set<T>::const_iterator end)
-     : std::set<T>(beg,end){};
+     : std::pmr::set<T>(beg,end){};
     Set<T> ( const Product<T>& p)
-     : std::set<T>(p.begin(),p.end()){};
+     : std::pmr::set<T>(p.begin(),p.end()){};
     // add t to set
     Set<T> & operator *= (T const & t);
     // add product to set
@@ -2,6 +2,7 @@
 #define Sum_H
 
 #include <map>
+#include <memory_resource>
 #include <iostream>
 #include <sstream>
 #include <cmath>
@@ -11,9 +12,10 @@
 
 /*
     Implements a sum (M.Hanrath)
+    The nodes are allocated from the default memory resource (see Arena)
 */
 template <class Object, class Field>
-class Sum : public std::map<Object, Field> {
+class Sum : public std::pmr::map<Object, Field> {
   public:
     // inplace addition of an Object
     Sum<Object, Field> &  operator += (Object const & o);
@@ -57,28 +57,29 @@ static std::string nextName(const std::string& s, const std::string& oldname){
 }
 
 SlotType::SlotType(const std::string& lettertype)
+  : _index(0)
 {
-  bool explspin = Input::iPars["prog"]["explspin"];
+  bool explspin = Input::config.explspin;
   TsPar& orbs = Input::sPars["syntax"];
   if (explspin){
     if ( curlyfind(orbs["occAorb"],lettertype) != std::string::npos ) {
       _type = SlotType::OccA;
-      _nIndices = Input::iPars["fact"]["nocc"];
+      _nIndices = Input::config.nocc;
       _internalName = "occAorb";
     } 
     else if ( curlyfind(orbs["occBorb"],lettertype) != std::string::npos ) {
       _type = SlotType::OccB;
-      _nIndices = Input::iPars["fact"]["nocc"];
+      _nIndices = Input::config.nocc;
       _internalName = "occBorb";
     } 
     else if ( curlyfind(orbs["virAorb"],lettertype) != std::string::npos ) {
       _type = SlotType::VirtA;
-      _nIndices = Input::iPars["fact"]["nvir"];
+      _nIndices = Input::config.nvir;
       _internalName = "virAorb";
     } 
     else if ( curlyfind(orbs["virBorb"],lettertype) != std::string::npos ) {
       _type = SlotType::VirtB;
-      _nIndices = Input::iPars["fact"]["nvir"];
+      _nIndices = Input::config.nvir;
       _internalName = "virBorb";
     } 
     else
@@ -87,21 +88,21 @@ SlotType::SlotType(const std::string& lettertype)
   else{
     if ( curlyfind(orbs["occorb"],lettertype) != std::string::npos ) {
       _type = SlotType::Occ;
-      _nIndices = Input::iPars["fact"]["nocc"];
+      _nIndices = Input::config.nocc;
       _internalName = "occorb";
     } else if ( curlyfind(orbs["virorb"],lettertype) != std::string::npos ) {
       _type = SlotType::Virt;
-      _nIndices = Input::iPars["fact"]["nvir"];
+      _nIndices = Input::config.nvir;
       _internalName = "virorb";
     } else if ( curlyfind(orbs["actorb"],lettertype) != std::string::npos ) {
       _type = SlotType::Act;
-      _nIndices = Input::iPars["fact"]["nact"];
+      _nIndices = Input::config.nact;
       _internalName = "actorb";
     } else if ( curlyfind(orbs["genorb"],lettertype) != std::string::npos ) {
       _type = SlotType::GenT;
-      _nIndices = Input::iPars["fact"]["nocc"]+Input::iPars["fact"]["nvir"];
+      _nIndices = Input::config.nocc+Input::config.nvir;
       _internalName = "genorb";
-      if ( Input::iPars["prog"]["multiref"] > 0 ) _nIndices += Input::iPars["fact"]["nact"];
+      if ( Input::config.multiref > 0 ) _nIndices += Input::config.nact;
     } else {
       error("Unknown letter-type space!","SlotType constructor");
     }
@@ -452,9 +453,10 @@ bool Tensor::operator<(const Tensor& ten) const
   if ( ten._syms.size() < _syms.size() ) return false;
   if ( _cuts.size() < ten._cuts.size() ) return true;
   if ( ten._cuts.size() < _cuts.size() ) return false;
+  // slot types which were added later come first
   for ( uint i = 0; i < _slots.size(); ++i ){
-    if ( _slots[i] < ten._slots[i] ) return true;
-    if ( ten._slots[i] < _slots[i] ) return false;
+    if ( _slots[i]->index() > ten._slots[i]->index() ) return true;
+    if ( ten._slots[i]->index() > _slots[i]->index() ) return false;
   }
   for ( uint i = 0; i < _syms.size(); ++i ){
     if ( _syms[i] < ten._syms[i] ) return true;
@@ -36,16 +36,19 @@ public:
     VirtB = 10,
     VirtA = 11
   };
-  SlotType(Length n = 0, Type type = NoType) : _nIndices(n), _type(type) {};
+  SlotType(Length n = 0, Type type = NoType) : _nIndices(n), _type(type), _index(0) {};
   SlotType(const std::string& lettertype);
   bool operator < ( const SlotType& st) const;
   Length length() const { return _nIndices; };
   SlotType::Type type() const { return _type; };
   std::string name(const std::string & oldname = "") const;
+  //! position in the expression (in order of addition), used to order the tensors
+  uint index() const { return _index; };
 //private:
   Length _nIndices;
   Type _type;
   std::string _internalName;
+  uint _index;
 };
 
 //! output operator for slot types
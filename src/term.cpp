@@ -1,4 +1,6 @@
 #include "term.h"
+#include "wick.h"
+#include "normalorder.h"
 
 Term::Term() : _prefac(1), _lastel(0), _matconnectionsset(false)
 {
@@ -441,6 +443,25 @@ bool Term::operator < (Term const & t) const
 return true;
 }
 
+uint64_t Term::equalkey() const
+{
+  uint64_t key = _mat.size() | uint64_t(_orbs.size() & 0xFFFF) << 16 |
+                 uint64_t(_sumorbs.size() & 0xFFFF) << 32 | uint64_t(_nocc & 0xFFFF) << 48;
+  // orderless: sums of mixed hashes of the orbital types and spins (external and internal)
+  // and of the matrices which are compared in the connection lines
+  auto mix = [](uint64_t h){ h *= 0x9E3779B97F4A7C15ull; return h ^ (h >> 29); };
+  uint64_t korbs = 0, kmats = 0;
+  for ( const auto& orb: extindx() )
+    korbs += mix(2*(orb.type() + Orbital::MaxType*orb.spin().spinhash()) + 1);
+  for ( const auto& orb: _sumorbs )
+    korbs += mix(2*(orb.type() + Orbital::MaxType*orb.spin().spinhash()));
+  for ( const auto& mat: _mat ) {
+    if ( InSet(mat.type(),Ops::Deexc0,Ops::Exc0) || mat.orbitals().size() == 0 ) continue;
+    kmats += mix(std::hash<std::string>()(mat.name()) ^ (uint64_t(mat.type()) << 48) ^ (uint64_t(mat.orbitals().size()) << 32));
+  }
+  return (key ^ korbs) * 0x100000001B3ull + kmats;
+}
+
 bool Term::equal(Term& t, Permut& perm)
 {
   if (_mat.size() != t._mat.size() ||
@@ -449,26 +470,63 @@ bool Term::equal(Term& t, Permut& perm)
       // _nintloops != t._nintloops || 
       _nocc != t._nocc) return false;
 //   xout << "compare " << *this << "  and  " << t << std::endl;
-  // generate Product of all orbitals and external-lines orbitals
-  TOrbSet peo(extindx()), peot(t.extindx()),
-          // external creator lines
-          pceo(extcreaindx()), pceot(t.extcreaindx());
-  List<Orbital> po(peo),pot(peot); // start with external lines!
-  po*=_sumorbs; // internal indices
-  pot*=t._sumorbs; // internal indices
+  // all orbitals (external lines first, in the order of TOrbSet) and the flags for each orbital
+  // (external, external from a creator operator, handled already)
+  // the matching is done in place: the vertices and handled orbitals of the current line are
+  // recorded in an undo log and reset if the line doesn't match
+  typedef SmallVector<Orbital,32> Orbs;
+  typedef SmallVector<unsigned char,32> Flags;
+  enum { Exter = 1, ExtCrea = 2, Done = 4 };
+  auto allorbs = [](const Term& term, Orbs& orbs, Flags& flags) {
+    for ( const auto& m: term._mat )
+      for ( const auto& orb: m.orbitals() )
+        if ( term._sumorbs.count(orb) == 0 && std::find(orbs.begin(),orbs.end(),orb) == orbs.end() )
+          orbs.push_back(orb);
+    std::sort(orbs.begin(),orbs.end());
+    flags.resize(orbs.size(),Exter);
+    for ( const auto& m: term._mat ) {
+      if (!InSet(m.type(),Ops::Exc0,Ops::Deexc0)) continue;
+      for ( uint i = 0; i < m.orbitals().size(); ++i )
+        if ( m.genderguess(i) == SQOpT::Creator && term._sumorbs.count(m.orbitals()[i]) == 0 )
+          flags[std::find(orbs.begin(),orbs.end(),m.orbitals()[i])-orbs.begin()] |= ExtCrea;
+    }
+    for ( const auto& orb: term._sumorbs ) {
+      orbs.push_back(orb);
+      flags.push_back(0);
+    }
+  };
+  Orbs po, pot;
+  Flags fo, fot;
+  allorbs(*this,po,fo);
+  allorbs(t,pot,fot);
   if (po.size() != pot.size()) return false;
-  Product<Matrix> mat, tmat;
-  Product<Orbital> por, port;
-  Permut perm1;
+  auto index = [](const Orbs& orbs, const Orbital& orb) -> uint {
+    uint idx = std::find(orbs.begin(),orbs.end(),orb)-orbs.begin();
+    assert( idx < orbs.size() );
+    return idx;
+  };
+  // undo log: handled orbitals (index in po and pot), matrices with set vertices (in _mat and t._mat)
+  SmallVector<uint,32> donelog, donelogt;
+  SmallVector<std::pair<uint,uint>,16> vertlog;
+  // permutations of external orbitals of the current line
+  SmallVector<std::pair<Orbital,Orbital>,8> permlog;
+  auto setdone = [&](uint io, uint iot) {
+    if ( !(fo[io] & Done) ) {
+      fo[io] |= Done;
+      donelog.push_back(io);
+    }
+    if ( !(fot[iot] & Done) ) {
+      fot[iot] |= Done;
+      donelogt.push_back(iot);
+    }
+  };
   Orbital orb,orb1,orbt,orb1t;
   long int ipos=0,ipost=0;
-  List<Orbital>::iterator it;
-  Product<Orbital>::iterator jt;
-  unsigned int ithis=0,ithist=0,i;
+  unsigned int ithis=0,ithist=0,i,io,iot;
   bool equal=false,exter,extert,exter1,extert1,loop,loopt,
        // is it an external creator line?
        extcr,extcrt;
-  Order ordmat, ordmatt, oordmat, oordmatt;
+  SmallVector<uint,16> ordmat, ordmatt, oordmat, oordmatt;
   for (i=0; i<_mat.size(); i++) {
     _mat[i].reset_vertices();
     t._mat[i].reset_vertices();
@@ -487,17 +545,17 @@ bool Term::equal(Term& t, Permut& perm)
   for (i=0; i<oordmatt.size(); i++)
     ordmatt.push_back(oordmatt[i]);
   loop = false;
-  while (po.size()>0) {
-    orb=po.front();
-    exter=(peo.count(orb)); //external orbital
-    extcr=(pceo.count(orb)); // external orbital from a creator operator
-    it = pot.begin();
-    i = 0;
+  for (;;) {
+    // first orbital which is not handled yet
+    for ( io = 0; io < po.size() && (fo[io] & Done); ++io ) {}
+    if ( io == po.size() ) break;
+    orb=po[io];
+    exter=(fo[io] & Exter); //external orbital
+    extcr=(fo[io] & ExtCrea); // external orbital from a creator operator
     equal=false;
-    while (it != pot.end() && pot.size()>0 && !equal) {
-      orbt = *it;
-      ++it;
-      ++i;
+    for ( iot = 0; iot < pot.size() && !equal; ++iot ) {
+      if ( fot[iot] & Done ) continue;
+      orbt = pot[iot];
       if (orb.type()!=orbt.type()) {
         equal=false;
         continue;
@@ -506,12 +564,12 @@ bool Term::equal(Term& t, Permut& perm)
         equal=false;
         continue;
       }
-      extert=(peot.count(orbt));
+      extert=(fot[iot] & Exter);
       if (exter!=extert) {// one is external orbital and the other not
         equal=false;
         continue;
       }
-      extcrt=(pceot.count(orbt));
+      extcrt=(fot[iot] & ExtCrea);
       if (extcr != extcrt){
         // one comes from external creator operator and the other not
         equal=false;
@@ -519,37 +577,36 @@ bool Term::equal(Term& t, Permut& perm)
       }
       orb1=orb;
       orb1t=orbt;
-      port = por = Product<Orbital>();
-      mat=_mat;
-      tmat=t._mat;
-      perm1=perm;
+      donelog.clear();
+      donelogt.clear();
+      vertlog.clear();
+      permlog.clear();
       equal=true;
       exter1=extert1=false;
-      if (exter) { //add orbitals to the product for removing
-        por*=orb1;
-        port*=orb1t;
+      if (exter) { // orbitals are handled
+        setdone(io,iot);
         if (orb1 != orb1t) { // external orbitals not match -> add permutation
-          perm1 += Permut(orb1t,orb1);
+          permlog.push_back({orb1t,orb1});
         }
       }
-      assert(ordmat.size() == mat.size());
+      assert(ordmat.size() == _mat.size());
       for (unsigned int jo=0; jo<ordmat.size(); jo++) {
         unsigned int j = ordmat[jo];
-        ipos = mat[j].orbitals().find(orb1);
+        ipos = _mat[j].orbitals().find(orb1);
         if (ipos >= 0) {
           ithis=j;
           break;
         }
       }
-      SQOpT::Gender genorb = mat[ithis].genderguess(ipos);
-      assert(ordmatt.size() == tmat.size());
+      SQOpT::Gender genorb = _mat[ithis].genderguess(ipos);
+      assert(ordmatt.size() == t._mat.size());
       ipost = -1;
       for (unsigned int jo=0; jo<ordmatt.size(); jo++) {
         unsigned int j = ordmatt[jo];
         ++ipost;
-        ipost = tmat[j].orbitals().find(orb1t,ipost);
+        ipost = t._mat[j].orbitals().find(orb1t,ipost);
         if (ipost >= 0 ) {
-          if ( !exter && tmat[j].genderguess(ipost) != genorb) {
+          if ( !exter && t._mat[j].genderguess(ipost) != genorb) {
             // orbitals come from different gendered operators
             // exclude external indices from the gender-check because of the ambiguity in particle-nonconserved matrices
             --jo; // check same matrix again
@@ -563,72 +620,64 @@ bool Term::equal(Term& t, Permut& perm)
       if ( ipost < 0 ) {
         // not found
         equal=false;
-        continue;
-      }
-      do {
+      } else do {
         // find orbital which corresponds to the same electron
-        const ConLine& cl = mat[ithis].conline(ipos);
+        const ConLine& cl = _mat[ithis].conline(ipos);
         ithis = cl.imat;
         ipos = cl.idx;
-        ipos = mat[ithis].iorbel(ipos);
+        ipos = _mat[ithis].iorbel(ipos);
         if ( ipos < 0 ) break;
-        orb1 = mat[ithis].orbitals()[ipos];
+        orb1 = _mat[ithis].orbitals()[ipos];
 
-        const ConLine& clt = tmat[ithist].conline(ipost);
+        const ConLine& clt = t._mat[ithist].conline(ipost);
         ithist = clt.imat;
         ipost = clt.idx;
-        ipost = tmat[ithist].iorbel(ipost);
+        ipost = t._mat[ithist].iorbel(ipost);
         if ( ipost < 0 ) break;
-        orb1t = tmat[ithist].orbitals()[ipost];
+        orb1t = t._mat[ithist].orbitals()[ipost];
 
-        if (orb1.type() != orb1t.type() || !mat[ithis].vertices(ipos,tmat[ithist],ipost,ithis) ||
-            mat[ithis].genderguess(ipos) != tmat[ithist].genderguess(ipost) )
+        bool newvert = ( _mat[ithis].vertindx() < 0 );
+        if (orb1.type() != orb1t.type() || !_mat[ithis].vertices(ipos,t._mat[ithist],ipost,ithis) ||
+            _mat[ithis].genderguess(ipos) != t._mat[ithist].genderguess(ipost) )
           equal=false;
         else {
-          exter1= (peo.count(orb1));
-          extert1= (peot.count(orb1t));
+          exter1= (_sumorbs.count(orb1) == 0);
+          extert1= (t._sumorbs.count(orb1t) == 0);
           if (exter1!=extert1) { // if one of indices is external and the other not
             equal=false;
-            break;
-          }
-          loop = (orb1==orb);
-          loopt = (orb1t==orbt);
-          if ((loop != loopt)&&!exter1) { // in one of matrices we have a loop and in the other not, and the index is not external!
+          } else {
+            loop = (orb1==orb);
+            loopt = (orb1t==orbt);
+            if ((loop != loopt)&&!exter1) { // in one of matrices we have a loop and in the other not, and the index is not external!
               equal=false;
-              break;
-          }
-          if (orb1.spin()!=orb1t.spin()){
-            equal=false;
-            break;
-          }
-          // add orbitals to the product for removing
-          por*=orb1;
-          port*=orb1t;
-          if (exter1 && orb1 != orb1t) { // external orbitals not match -> add permutation
-            perm1 += Permut(orb1t,orb1);
+            } else if (orb1.spin()!=orb1t.spin()){
+              equal=false;
+            } else {
+              // orbitals are handled
+              setdone(index(po,orb1),index(pot,orb1t));
+              if (exter1 && orb1 != orb1t) { // external orbitals not match -> add permutation
+                permlog.push_back({orb1t,orb1});
+              }
+            }
           }
         }
+        if ( newvert && _mat[ithis].vertindx() >= 0 )
+          vertlog.push_back({ithis,ithist});
       } while (equal && !loop && !exter1);
       if(equal) {
-        // set _mat and t._mat to mat and tmat
-        _mat=mat;
-        t._mat=tmat;
-        //set permutator to perm1
-        perm=perm1;
-        // remove por and port from product of orbitals (we dont need to handle this orbital again!)
-        for ( jt = por.begin(); jt != por.end(); ++jt) {
-          it = std::find(po.begin(),po.end(),*jt);
-          assert( it != po.end() );
-          po.erase(it);
-        }
-        for ( jt = port.begin(); jt != port.end(); ++jt) {
-          it = std::find(pot.begin(),pot.end(),*jt);
-          assert( it != pot.end() );
-          pot.erase(it);
+        for ( const auto& pm: permlog )
+          perm += Permut(pm.first,pm.second);
+      } else {
+        // undo
+        for ( const auto& vl: vertlog ) {
+          _mat[vl.first].reset_vertices();
+          t._mat[vl.second].reset_vertices();
         }
+        for ( uint idx: donelog ) fo[idx] &= ~Done;
+        for ( uint idx: donelogt ) fot[idx] &= ~Done;
       }
     }
-    if (!equal && i>=pot.size())
+    if (!equal)
       break;
   }
   return equal;
@@ -689,35 +738,7 @@ TermSum Term::normalOrder_fullyContractedOnly() const
 
 TermSum Term::normalOrder(bool fullyContractedOnly) const
 {
-    TermSum  sum;
-    for ( unsigned int i=0 ; i+1<_opProd.size() ; ++i ) // iterate over Product<SQOp> but the last
-    {
-        // check if two consecutive operators need reordering
-        if ( _opProd[i].gender()==SQOpT::Annihilator  &&  _opProd[i+1].gender()==SQOpT::Creator ) {   // yes
-          // handle 1st term
-          Product<SQOp> p(_opProd); // copy Product<SQOp>
-          std::swap(p[i], p[i+1]); // swap operators
-          // check if we need downward recursion
-          if ( !fullyContractedOnly || p[_opProd.size()-1].gender()==SQOpT::Creator )
-            sum -= Term(p, _kProd, _mat, _orbs, _sumorbs, _prefac, _connections).normalOrder(fullyContractedOnly);
-
-            // handle 2nd term
-          Product<SQOp> q(p);   // copy Product<SQOp>
-          q.erase(q.begin()+i,q.begin()+i+2);
-          // q.erase(std::find(q.begin(), q.end(), p[i]));        // remove
-          // q.erase(std::find(q.begin(), q.end(), p[i+1]));      // operators
-
-          Product<Kronecker>  d(_kProd);
-          d *= Kronecker(p[i].orb(), p[i+1].orb());           // and add kronecker
-          // check if we need downward recursion
-          if ( !fullyContractedOnly || q.size()==0 || q[q.size()-1].gender()==SQOpT::Creator )
-            sum += Term(q, d, _mat, _orbs, _sumorbs, _prefac, _connections).normalOrder(fullyContractedOnly);
-          return sum;
-        }
-    }
-
-    sum += *this;   // add current term to the intermediate sum
-    return sum;
+  return normalOrder(NormalOrderer::patterns(_opProd,false,fullyContractedOnly));
 }
 
 TermSum Term::normalOrderPH() const
@@ -728,47 +749,37 @@ TermSum Term::normalOrderPH_fullyContractedOnly() const
 
 
 TermSum Term::normalOrderPH(bool fullyContractedOnly) const
+{
+  return normalOrder(NormalOrderer::patterns(_opProd,true,fullyContractedOnly));
+}
+
+TermSum Term::normalOrder(const std::vector<NOPattern>& patterns) const
 {
   TermSum  sum;
-  bool creat2, annih1;
-  for ( unsigned int i=0 ; i+1<_opProd.size() ; ++i ) {// iterate over Product<SQOp> but the last
-    // check if two consecutive operators need reordering
-    creat2=(( _opProd[i].genderPH()==SQOpT::Annihilator || _opProd[i].genderPH()==SQOpT::Gen )
-              &&  _opProd[i+1].genderPH()==SQOpT::Creator );
-    annih1=(_opProd[i].genderPH()==SQOpT::Annihilator
-              && ( _opProd[i+1].genderPH()==SQOpT::Creator || _opProd[i+1].genderPH()==SQOpT::Gen));
-    if ( creat2 || annih1 ) {   // yes
-      // handle 1st term
-      Product<SQOp> p(_opProd); // copy Product<SQOp>
-      std::swap(p[i], p[i+1]); // swap operators
-      // check if we need downward recursion
-      if ( !fullyContractedOnly || (p[_opProd.size()-1].genderPH()==SQOpT::Creator)
-                || (p[0].genderPH()==SQOpT::Annihilator))
-        sum -= Term(p, _kProd, _mat, _orbs, _sumorbs, _prefac, _connections).normalOrderPH(fullyContractedOnly);
-
-      if ( _opProd[i].orb().type()==_opProd[i+1].orb().type() ||
-               ( ( _opProd[i].orb().type()==Orbital::GenT || _opProd[i+1].orb().type()==Orbital::GenT )
-                 && _opProd[i].gender()!=_opProd[i+1].gender() )) {
-        // handle 2nd term
-        Product<SQOp> q(p);   // copy Product<SQOp>
-        q.erase(q.begin()+i,q.begin()+i+2);
-
-        Product<Kronecker>  d(_kProd);
-        d *= Kronecker(p[i].orb(), p[i+1].orb());           // and add kronecker
-        // check if we need downward recursion
-        if ( !fullyContractedOnly || q.size()==0 || q[q.size()-1].genderPH()==SQOpT::Creator
-                || q[0].genderPH()==SQOpT::Annihilator)
-              sum += Term(q, d, _mat, _orbs, _sumorbs, _prefac, _connections).normalOrderPH(fullyContractedOnly);
-      }
-      return sum;
+  for ( const NOPattern& pat: patterns ) {
+    if ( pat.orig ) {
+      sum += *this;   // no reordering needed
+      continue;
     }
+    Product<SQOp> p;
+    for ( unsigned char i: pat.ops )
+      p.push_back(_opProd[i]);
+    Product<Kronecker>  d(_kProd);
+    for ( uint k = 0; k < pat.krons.size(); k += 2 )
+      d *= Kronecker(_opProd[pat.krons[k]].orb(), _opProd[pat.krons[k+1]].orb());
+    sum += std::make_pair(Term(p, d, _mat, _orbs, _sumorbs, _prefac, _connections),TFactor(pat.sign));
   }
-  if ( !fullyContractedOnly || _opProd.size()==0 )
-    sum += *this;   // add current term to the intermediate sum
   return sum;
 }
 
-TermSum Term::wickstheorem(bool genw, int noord) const
+TermSum Term::wickstheorem(bool genw, int noord, bool conn, bool symm) const
+{
+  TermSum sum;
+  wickstheorem([&sum](const Term& term, const TFactor& fac){ sum += std::make_pair(term,fac); },
+               genw,noord,conn,symm);
+  return sum;
+}
+void Term::wickstheorem(const TermSink& sink, bool genw, int noord, bool conn, bool symm) const
 {
   // generate "matrix" of indices to SQops
   TWOps opers;
@@ -784,7 +795,7 @@ TermSum Term::wickstheorem(bool genw, int noord) const
     } else
       assert(false);
   }
-  if ( cran != 0 ) return TermSum();
+  if ( cran != 0 ) return;
   for (unsigned int i=0; i<_opProd.size(); i++) {
     if (m==_mat.size()) { // all SQops, which are not in Matrix have to be added as individual vectors
       opermat.push_back(i);
@@ -814,194 +825,199 @@ TermSum Term::wickstheorem(bool genw, int noord) const
 //       std::cout << *ijop << " " ;
 //     std::cout << std::endl;
 //   }
-  if (genw){
-    TWMats densmat;
-    return genwick(opers,opermat,densmat);
-  } else {
-    return wick(opers,opermat);
-  }
-}
-
-TermSum Term::wick(TWOps& opers, TWMats& krons) const
-{
-  TermSum  sum;
-  if (opers.size()==0) { // no SQoperators left
-    Product<SQOp> p;
-    // generate Kroneckers
-    Product<Kronecker> d;
-    assert(krons.size()%2 == 0);
-    for (TWMats::iterator kr = krons.begin(); kr != krons.end(); ++kr){
-      TWMats::iterator kr0 = kr;
-      ++kr;
-      d*=Kronecker(_opProd[*kr0].orb(),_opProd[*kr].orb());
+  WickContractor contractor(_opProd,opers,genw);
+  if ( conn && _mat.size() <= WickContractor::maxops ) {
+    // matrices that have to be connected
+    std::vector<WickContractor::Mask> groups;
+    for ( const auto& con: _connections ) {
+      if ( con[0] < 0 ) continue;
+      WickContractor::Mask grp = 0;
+      for ( long int imat: con )
+        grp |= WickContractor::Mask(1) << (labs(imat)-1);
+      groups.push_back(grp);
     }
-    sum += Term(p,d,_mat, _orbs, _sumorbs, _prefac, _connections);
-    return sum;
-  }
-  lui istart,sign;
-  TWOps::iterator ifirstop = opers.begin();
-  int curr=*(ifirstop->begin());
-  SQOpT::Gender gencurr=_opProd[curr].gender();
-  Orbital::Type orbtypecurr=_opProd[curr].orb().type();
-  bool orbcurrgen = (orbtypecurr==Orbital::GenT);
-  if ( _opProd[curr].genderPH() == SQOpT::Creator ) {
-    // quasi-Creator on the left --> this term is zero
-    return sum;
-  }
-  // remove first SQop-index
-  if (ifirstop->size() == 1) {
-    opers.erase(ifirstop);
-    istart=0;
-  } else {
-    ifirstop->erase(ifirstop->begin());
-    istart=1;
-  }
-  // add first index to krons1
-  krons.push_back(curr);
-  sign=0;
-  uint ii = 0;
-  for ( TWOps::iterator iop = opers.begin(); iop != opers.end(); ++iop, ++ii ) { // iterate over all Operators
-    if (ii < istart) { //but the first
-      //count SQops for sign
-      sign+=iop->size();
-      continue;
-    }
-    uint jj = 0;
-    for ( TWMats::iterator ijop = iop->begin(); ijop != iop->end(); ++ijop, ++jj ) {// iterate over all SQop in Operator i
-      // check if the first operator and operator i would yield a Kronecker
-      const SQOp& op = _opProd[*ijop];
-      Orbital::Type oporbtype = op.orb().type();
-      if (op.gender()!=gencurr && op.genderPH() != SQOpT::Annihilator &&
-          (orbcurrgen || oporbtype == orbtypecurr|| oporbtype == Orbital::GenT)) {
-        // copy opers and krons
-        TWOps opers1(opers);
-        TWMats krons1(krons);
-        // remove SQop-index
-        TWOps::iterator iop1 = opers1.begin();
-        std::advance(iop1,ii);
-        if (iop1->size() == 1)
-          opers1.erase(iop1);
-        else {
-          TWMats::iterator ijop1 = iop1->begin();
-          std::advance(ijop1,jj);
-          iop1->erase(ijop1);
-        }
-        // add index to "Kronecker"
-        krons1.push_back(*ijop);
-        //call wick recursivly
-        if ((sign+jj)%2 == 0)
-          sum+=wick(opers1,krons1);
-        else
-          sum-=wick(opers1,krons1);
-      }
+    if ( groups.size() > 0 ) {
+      // matrices connected by common orbitals already
+      std::vector<WickContractor::Mask> matadj(_mat.size(),0);
+      for ( uint i = 0; i < _mat.size(); ++i )
+        for ( const auto& orb: _mat[i].orbitals() )
+          for ( uint k = i+1; k < _mat.size(); ++k )
+            if ( _mat[k].orbitals().find(orb) >= 0 ) {
+              matadj[i] |= WickContractor::Mask(1) << k;
+              matadj[k] |= WickContractor::Mask(1) << i;
+            }
+      // matrices with the orbital of each SQop
+      std::vector<WickContractor::Mask> opmats(_opProd.size(),0);
+      for ( uint i = 0; i < _opProd.size(); ++i )
+        for ( uint k = 0; k < _mat.size(); ++k )
+          if ( _mat[k].orbitals().find(_opProd[i].orb()) >= 0 )
+            opmats[i] |= WickContractor::Mask(1) << k;
+      contractor.set_connected(opmats,matadj,groups);
     }
-    sign+=iop->size();
   }
-  return sum;
-}
-
-TermSum Term::genwick(Term::TWOps& opers, const Term::TWMats& krons, Term::TWMats densmat) const
-{
-  TermSum  sum;
-  if (opers.size()==0) { // no SQoperators left
+  if ( symm && !genw && noord == 0 ) contractor.set_symmetry(wicksymmetry());
+  contractor.contract([&](const WickContraction& contr){
     Product<SQOp> p;
     // generate Kroneckers
     Product<Kronecker> d;
-    assert(krons.size()%2 == 0);
-    for (TWMats::const_iterator kr = krons.begin(); kr != krons.end(); ++kr){
-      TWMats::const_iterator kr0 = kr;
-      ++kr;
-      d*=Kronecker(_opProd[*kr0].orb(),_opProd[*kr].orb());
-    }
-    // add density matrices
-    Product<Orbital> dmorbs;
-    Product<SQOpT::Gender> dmcran;
-    assert(densmat.size()%2 == 0);
-    for (TWMats::const_iterator dm = densmat.begin(); dm != densmat.end(); ++dm){
-      dmorbs.push_back(_opProd[*dm].orb());
-      dmcran.push_back(_opProd[*dm].gender());
-    }
-    if (dmorbs.size() > 0){
+    for ( uint k = 0; k < contr.nkrons; ++k )
+      d*=Kronecker(_opProd[contr.krons[2*k]].orb(),_opProd[contr.krons[2*k+1]].orb());
+    Term term;
+    if ( contr.ndm > 0 ) {
+      // add density matrix
+      Product<Orbital> dmorbs;
+      Product<SQOpT::Gender> dmcran;
+      assert(contr.ndm%2 == 0);
+      for ( uint k = 0; k < contr.ndm; ++k ){
+        dmorbs.push_back(_opProd[contr.dm[k]].orb());
+        dmcran.push_back(_opProd[contr.dm[k]].gender());
+      }
       Product<Matrix> mat(_mat);
       short npair = dmorbs.size()/2;
       mat *= Matrix(Ops::DensM,dmorbs,npair);
       mat.back().set_cran(dmcran);
-      sum += Term(p,d,mat, _orbs, _sumorbs, _prefac, _connections);
+      term = Term(p,d,mat, _orbs, _sumorbs, _prefac, _connections);
     } else {
-      sum += Term(p,d,_mat, _orbs, _sumorbs, _prefac, _connections);
+      term = Term(p,d,_mat, _orbs, _sumorbs, _prefac, _connections);
     }
-    return sum;
-  }
-  lui istart,sign;
-  TWOps::iterator ifirstop = opers.begin();
-  int curr = *(ifirstop->begin());
-  SQOpT::Gender gencurr = _opProd[curr].gender();
-  Orbital::Type orbtypecurr = _opProd[curr].orb().type();
-  bool orbcurrgen = (orbtypecurr==Orbital::GenT);
-  bool orbcurract = (orbtypecurr==Orbital::Act);
-  if ( _opProd[curr].genderPH() == SQOpT::Creator ) {
-    // quasi-Creator on the left --> this term is zero
-    return sum;
-  }
-  // remove first SQop-index
-  if (ifirstop->size() == 1) {
-    opers.erase(ifirstop);
-    istart=0;
-  } else {
-    ifirstop->erase(ifirstop->begin());
-    istart=1;
-  }
-  sign=0;
-  uint ii = 0;
-  for ( TWOps::iterator iop = opers.begin(); iop != opers.end(); ++iop, ++ii ) { // iterate over all Operators
-    if (ii < istart) { //but the first
-      //count SQops for sign
-      sign+=iop->size();
-      continue;
+    sink(term,TFactor(contr.sign*int(contr.weight)));
+  });
+}
+
+std::vector< std::vector<uint> > Term::wicksymmetry() const
+{
+  typedef std::vector<uint> Perm;
+  uint nops = _opProd.size();
+  std::vector<Perm> group;
+  Perm ident(nops);
+  for ( uint i = 0; i < nops; ++i ) ident[i] = i;
+  group.push_back(ident);
+  // position of the SQop for each orbital (-1 if not unique)
+  auto oppos = [this](const Orbital& orb) -> long int {
+    long int ipos = -1;
+    for ( uint i = 0; i < _opProd.size(); ++i )
+      if ( _opProd[i].orb() == orb ) {
+        if ( ipos >= 0 ) return -1;
+        ipos = i;
+      }
+    return ipos;
+  };
+  // can the orbitals of the matrix be renamed?
+  // (summation orbitals, each with one SQop, and neither the orbitals nor their electrons
+  //  are present in other matrices)
+  auto renameable = [&](uint imat) -> bool {
+    for ( const auto& orb: _mat[imat].orbitals() ) {
+      if ( _sumorbs.count(orb) == 0 || oppos(orb) < 0 ) return false;
+      for ( uint k = 0; k < _mat.size(); ++k ) {
+        if ( k == imat ) continue;
+        for ( const auto& orbk: _mat[k].orbitals() )
+          if ( orbk == orb || ( orb.getel() != 0 && orbk.getel() == orb.getel() ) ) return false;
+      }
     }
-    uint jj = 0;
-    for ( TWMats::iterator ijop = iop->begin(); ijop != iop->end(); ++ijop, ++jj ) {// iterate over all SQop in Operator i
-      // check if the first operator and operator i would yield a Kronecker
-      const SQOp& op = _opProd[*ijop];
-      Orbital::Type oporbtype = op.orb().type();
-      if (op.gender()!=gencurr && op.genderPH() != SQOpT::Annihilator &&
-          (orbcurrgen || oporbtype == orbtypecurr|| oporbtype == Orbital::GenT)) {
-        // copy opers and krons
-        TWOps opers1(opers);
-        TWMats krons1(krons);
-//         TWMats densmat1(densmat);
-        // remove SQop-index
-        TWOps::iterator iop1 = opers1.begin();
-        std::advance(iop1,ii);
-        if (iop1->size() == 1)
-          opers1.erase(iop1);
-        else {
-          TWMats::iterator ijop1 = iop1->begin();
-          std::advance(ijop1,jj);
-          iop1->erase(ijop1);
+    return true;
+  };
+  // permutation of SQops which exchanges orbitals orbs1[k] and orbs2[k]
+  auto exchange = [&](const Product<Orbital>& orbs1, const Product<Orbital>& orbs2, Perm& perm) -> bool {
+    perm = ident;
+    for ( uint k = 0; k < orbs1.size(); ++k ) {
+      long int i = oppos(orbs1[k]), j = oppos(orbs2[k]);
+      const SQOp &opi = _opProd[i], &opj = _opProd[j];
+      if ( opi.gender() != opj.gender() || opi.orb().type() != opj.orb().type() ||
+           opi.orb().spin().type() != opj.orb().spin().type() ) return false;
+      perm[i] = j;
+      perm[j] = i;
+    }
+    return true;
+  };
+  // positions of the SQops of matrix imat
+  auto matops = [&](uint imat, long int& first, long int& last) {
+    first = nops;
+    last = -1;
+    for ( const auto& orb: _mat[imat].orbitals() ) {
+      long int ipos = oppos(orb);
+      first = std::min(first,ipos);
+      last = std::max(last,ipos);
+    }
+  };
+  std::vector<Perm> gens;
+  Perm perm;
+  std::vector<bool> renmat(_mat.size());
+  for ( uint imat = 0; imat < _mat.size(); ++imat ) {
+    const Matrix& mat = _mat[imat];
+    renmat[imat] = ( mat.orbitals().size() > 0 && renameable(imat) );
+    if ( !renmat[imat] ) continue;
+    // equivalent electrons
+    for ( const auto& ev: mat.equivertices() )
+      for ( uint iv = 1; iv < ev.size(); ++iv ) {
+        uint v1 = ev[iv-1].front(), v2 = ev[iv].front();
+        if ( v2 >= mat.npairs() ) continue;
+        if ( exchange(mat.orbitals().subprod(2*v1,2*v1+1),mat.orbitals().subprod(2*v2,2*v2+1),perm) )
+          gens.push_back(perm);
+      }
+  }
+  // identical neighbouring excitation (or deexcitation) operators
+  for ( uint imat = 1; imat < _mat.size(); ++imat ) {
+    const Matrix &mat1 = _mat[imat-1], &mat2 = _mat[imat];
+    if ( !renmat[imat-1] || !renmat[imat] || !mat1.equivalent(mat2) ||
+         !InSet(mat1.type(),Ops::Exc,Ops::Deexc) ) continue;
+    long int first1, last1, first2, last2;
+    matops(imat-1,first1,last1);
+    matops(imat,first2,last2);
+    uint nmatops = mat1.orbitals().size();
+    if ( nmatops%2 != 0 || last1+1 != first2 || last1-first1+1 != long(nmatops) ||
+         last2-first2+1 != long(nmatops) ) continue;
+    // all SQops have to be quasi-creators (or quasi-annihilators)
+    bool samegender = true;
+    for ( long int i = first1; i <= last2; ++i )
+      samegender = samegender && _opProd[i].genderPH() == _opProd[first1].genderPH() &&
+                   _opProd[i].genderPH() != SQOpT::Gen;
+    if ( !samegender ) continue;
+    // connections have to stay the same
+    ConnectionsMap swapped;
+    for ( const auto& con: _connections ) {
+      Product<long int> scon;
+      for ( long int ic: con ) {
+        long int jmat = labs(ic)-1;
+        if ( jmat == long(imat)-1 ) jmat = imat;
+        else if ( jmat == long(imat) ) jmat = imat-1;
+        scon.push_back( ic < 0 ? -(jmat+1) : jmat+1 );
+      }
+      std::sort(scon.begin(),scon.end());
+      swapped.push_back(scon);
+    }
+    bool sameconns = true;
+    for ( const auto& scon: swapped ) {
+      bool found = false;
+      for ( const auto& con: _connections ) {
+        Product<long int> scon0(con);
+        std::sort(scon0.begin(),scon0.end());
+        found = found || scon0 == scon;
+      }
+      sameconns = sameconns && found;
+    }
+    if ( sameconns && exchange(mat1.orbitals(),mat2.orbitals(),perm) )
+      gens.push_back(perm);
+  }
+  // generate the group
+  const uint maxgroup = 5040;
+  std::set<Perm> elements(group.begin(),group.end());
+  for ( uint ig = 0; ig < group.size(); ++ig )
+    for ( const Perm& gen: gens ) {
+      Perm prod(nops);
+      for ( uint i = 0; i < nops; ++i ) prod[i] = gen[group[ig][i]];
+      if ( elements.insert(prod).second ) {
+        if ( elements.size() > maxgroup ) {
+          warning("Symmetry group of the operator string is too large, will not be used");
+          group.resize(1);
+          return group;
         }
-        // add index to "Kronecker"
-        krons1.push_back(curr);
-        krons1.push_back(*ijop);
-        //call wick recursivly
-        if ((sign+jj)%2 == 0)
-          sum+=genwick(opers1,krons1,densmat);
-        else
-          sum-=genwick(opers1,krons1,densmat);
+        group.push_back(prod);
       }
     }
-    sign+=iop->size();
-  }
-  if (orbcurrgen || orbcurract) {
-    // add density matrix
-    densmat.push_front(curr);
-    if ((sign)%2 == 0)
-      sum+=genwick(opers,krons,densmat);
-    else
-      sum-=genwick(opers,krons,densmat);
-  }
-  return sum;
+  return group;
 }
+
+
 TermSum Term::change2fock(uint imat, const std::string& decoration, bool multiref ) const
 {
   assert( _mat[imat].type() == Ops::OneEl );
@@ -1076,7 +1092,7 @@ TermSum Term::dmwickstheorem(const Matrix& dm) const
     opers.push_back(i);
   }
   // only dmsort version is implemented yet...
-  assert(Input::iPars["prog"]["dmsort"] > 0);
+  assert(Input::config.dmsort > 0);
   assert(dm.get_cran().size() == dm.orbitals().size());
   return dmwick(opers,krons,dm);
 }
@@ -1191,7 +1207,7 @@ TermSum Term::dmwick(Term::TWMats& opers, const Term::TWMats& krons, const Matri
 
 TermSum Term::replaceE0byfock(uint imat, bool multiref, bool replaceE0act) const
 {
-  assert( _mat[imat].name() == Input::sPars["hamilton"]["E0"] );
+  assert( _mat[imat].name() == Input::config.e0 );
   TermSum sum;
   Term term(*this);
   // E^0 = \sum f_II [ + \sum f_TU \gamma^T_U]
@@ -1247,7 +1263,7 @@ void Term::setmatconnections()
       const Orbital& ijorb = _mat[i].orbitals()[j];
       if ( (kj = _mat[i].orbitals().find(ijorb,j+1)) >= 0 ) {
         // self-connection (non-normal-ordered hamiltonian)
-        assert(Input::iPars["prog"]["noorder"] > 0);
+        assert(Input::config.noorder > 0);
         _mat[i].add_connect(i+1);
 //        _mat[i].add_connect(i+1);
         _mat[i].set_conline(j,i,kj);
@@ -1495,8 +1511,8 @@ TermSum Term::oneel2fock(std::string decoration, bool multiref )
 }
 TermSum Term::replaceE0(bool multiref)
 {
-  std::string e0name = Input::sPars["hamilton"]["E0"];
-  bool replaceE0act = (Input::iPars["prog"]["replacee0"] > 1);
+  std::string e0name = Input::config.e0;
+  bool replaceE0act = (Input::config.replacee0 > 1);
   TermSum sum;
   for ( uint i = 0; i < _mat.size(); ++i ){
     if ( _mat[i].name() == e0name ){
@@ -1590,7 +1606,7 @@ bool Term::has_generalindices() const
 }
 TermSum Term::removegeneralindices()
 {
-  bool active = (Input::iPars["prog"]["multiref"] > 0);
+  bool active = (Input::config.multiref > 0);
   TermSum sum;
   this->set_lastorbs();
   Term tt(*this);
@@ -2224,53 +2240,73 @@ void Term::printdiag(Output* pout) const
   *(pout->pout) << diag["ediag"] << std::endl;
 }
 
+// The names of an orbital type are enumerated as i,j,...,o,ii,ij,...,oo,iii,...
+// (bijective numeration in the letters of the type).
+// Number of the letter-name in this enumeration (0 if it is not a name of this type)
+static lui letnamenum(const std::string& name, const unsigned char * letpos, lui nlets)
+{
+  lui num = 0, iend = name.size();
+  // remove numbers from end
+  while ( iend > 0 && std::isdigit((unsigned char)name[iend-1]) ) --iend;
+  for ( lui i = 0; i < iend; ++i ) {
+    unsigned char pos = letpos[(unsigned char)name[i]];
+    if ( pos == 0 || num > (lui(1) << 40) ) return 0;
+    num = num*nlets + pos;
+  }
+  return num;
+}
+// letter-name with number num
+static std::string letname4num(lui num, const std::string& lets)
+{
+  std::string name;
+  for ( ; num > 0; num = (num-1)/lets.size() )
+    name.insert(name.begin(),lets[(num-1)%lets.size()]);
+  return name;
+}
 Orbital Term::freeorbname(Orbital::Type type, bool spinfree)
 {
-  TsPar& orbs = Input::sPars["syntax"];
+  const Input::Config& conf = Input::config;
   Spin::Type spin = Spin::Gen;
   if (spinfree) {
     spin = Spin::No;
   } else {
-    bool spinintegr = Input::iPars["prog"]["spinintegr"];
+    bool spinintegr = conf.spinintegr;
     if (spinintegr) spin = Spin::GenS;
   }
   const std::string * ip_orbs;
-  std::string lastorb=_lastorb[type].letname();
-  unsigned long int indx;
   if (type==Orbital::Occ)
-    ip_orbs = & orbs["occorb"];
+    ip_orbs = & conf.occorb;
   else if (type==Orbital::Virt)
-    ip_orbs = & orbs["virorb"];
+    ip_orbs = & conf.virorb;
   else if (type==Orbital::Act)
-    ip_orbs = & orbs["actorb"];
+    ip_orbs = & conf.actorb;
   else
-    ip_orbs = & orbs["genorb"];
-  do {
-    if (lastorb.size()==0) {
-      lastorb=ip_orbs->at(0);
-      _lastorb[type]=Orbital(lastorb,type,spin);
-    } else {
-      bool lastorbset = false;
-      for ( int i=lastorb.size()-1; i>=0 && !lastorbset; --i) {
-        indx=ip_orbs->find(lastorb[i]);
-        if(indx==std::string::npos)
-          error("Something wrong with orbitals","Term::freeorbname");
-        else if (indx<ip_orbs->size()-1) {// not the last possible orbital index
-          lastorb[i]=ip_orbs->at(indx+1);
-          _lastorb[type]=Orbital(lastorb,type,spin);
-          lastorbset = true;
-        } else {
-          lastorb[i]=ip_orbs->at(0);//set to first letter
-        }
-      }
-      if (!lastorbset) {
-        //add one orbital index more
-        lastorb+=ip_orbs->at(0);
-        _lastorb[type]=Orbital(lastorb,type,spin);
-      }
+    ip_orbs = & conf.genorb;
+  const std::string& lets = *ip_orbs;
+  // position+1 of each letter
+  unsigned char letpos[256] = {};
+  for ( lui i = lets.size(); i > 0; --i )
+    letpos[(unsigned char)lets[i-1]] = i;
+  Orbital& lastorb = _lastorb[type];
+  // the next name after the last one, which is not used in the term
+  lui last = letnamenum(lastorb.name(),letpos,lets.size());
+  if ( last == 0 && !lastorb.name().empty() )
+    error("Something wrong with orbitals","Term::freeorbname");
+  for (;;) {
+    // bitmap of the used names last+1...last+64
+    uint64_t used = 0;
+    for ( const auto& orb: _orbs ){
+      lui num = letnamenum(orb.name(),letpos,lets.size());
+      if ( num > last && num <= last+64 ) used |= uint64_t(1) << (num-last-1);
     }
-  } while (_lastorb[type].is_in_set(_orbs));
-  return _lastorb[type];
+    if ( ~used != 0 ) {
+      last += __builtin_ctzll(~used)+1;
+      break;
+    }
+    last += 64;
+  }
+  lastorb = Orbital(letname4num(last,lets),type,spin);
+  return lastorb;
 }
 Orbital Term::getfreeorbname(void* Obj, Orbital::Type type)
 {
@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <cmath>
 #include <algorithm>
+#include <functional>
 #include "utilities.h"
 #include "globals.h"
 #include "types.h"
@@ -20,6 +21,9 @@ class SQOp;
 class Oper;
 class Term;
 typedef Sum<Term,TFactor> TermSum;
+// consumer of terms (with prefactors) generated one by one
+typedef std::function<void(const Term&, const TFactor&)> TermSink;
+struct NOPattern;
 /*!
     A term consists of a Product of SQOperators and a Product of Kroneckers
 */
@@ -98,6 +102,8 @@ class Term {
     bool removeit() const;
     //! artificial ordering
     bool operator < (Term const & t) const;
+    //! hash of the invariants compared in equal() (the same for terms which can be equal)
+    uint64_t equalkey() const;
     //! equal terms
     // terms will be not changed! (but const can't be applied)
     // perm: permutation which brings t-term to this term (if true at return)
@@ -114,13 +120,14 @@ class Term {
     TermSum  normalOrderPH_fullyContractedOnly() const;
     typedef std::list<int> TWMats;
     typedef std::list<TWMats> TWOps;
-    //! Wick's theorem: call recursive routine wick
+    //! Wick's theorem (enumeration of the full contractions in WickContractor)
     // if genw == true: use the generalized Wick's theorem
-    TermSum  wickstheorem(bool genw = false, int noord = 0) const;
-    //! Wick's theorem, recursive: opers contains index of SQop in _opProd (divided into individual operators)
-    TermSum  wick(TWOps& opers, TWMats& krons) const;
-    //! generalized Wick's theorem, recursive: opers contains index of SQop in _opProd (divided into individual operators)
-    TermSum  genwick(Term::TWOps& opers, const Term::TWMats& krons, Term::TWMats densmat) const;
+    // if conn == true: skip contractions that cannot fulfill the connections
+    // if symm == true: generate only one of the contractions that are equivalent by symmetry (with its weight)
+    TermSum  wickstheorem(bool genw = false, int noord = 0, bool conn = false, bool symm = false) const;
+    //! Wick's theorem, pass every contracted term to sink
+    void wickstheorem(const TermSink& sink, bool genw = false, int noord = 0, bool conn = false,
+                      bool symm = false) const;
     //! set connections for each matrix
     void setmatconnections();
     //! reduce equation (delete Kroneckers and summation indices)
@@ -237,6 +244,11 @@ class Term {
   private:
     TermSum  normalOrder(bool fullyContractedOnly) const;
     TermSum  normalOrderPH(bool fullyContractedOnly) const;
+    // instantiate normal ordered patterns for this term
+    TermSum  normalOrder(const std::vector<NOPattern>& patterns) const;
+    // permutations of SQops which leave the term unchanged up to renaming of summation indices
+    // (electrons in symmetric matrices and identical excitation operators), including identity
+    std::vector< std::vector<uint> > wicksymmetry() const;
 
     Product<SQOp> _opProd;
     // termsum factors from e.g. generalized normal ordered SQ-operators
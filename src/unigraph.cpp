@@ -1,8 +1,276 @@
 #include "unigraph.h"
+#include <array>
+#include <functional>
+#include <fstream>
+#include <sstream>
+
+namespace {
+/*
+    Colored graph of the vertices (nodes 0..nverts-1, connected by the lines) and of the matrices
+    (nodes nverts.., connected to their vertices) for the canonical labelling of a UniGraph.
+    The allowed relabellings are permutations of equivalent matrices and of equivalent vertices
+    in a matrix (_equivs), the leaves of the search tree are mapped to orders of vertices.
+    Vertices of allowed permutations (_eqperms) are not distinguished (their lines are permuted
+    afterwards in apply_eqperms), they have to stay in place.
+*/
+class VertexGraph {
+public:
+  // ordered partition of the nodes (cell index of each node)
+  typedef Order Cells;
+  // leaf: order of vertices (with a last element nverts) and the connection vector in this order
+  typedef std::function<void(const Order& vertorder, const Order& connections)> Leaf;
+  VertexGraph(const Order& vertconn, const Product<Matrix>& mats, const Order& matsord,
+              const Equivalents& equivs, const PermVertices& eqperms);
+  // vertices which are permuted by the equivalences
+  const std::vector<bool>& moved() const { return _moved; };
+  // search through the tree of individualized nodes, leaf is called for each distinct connection vector
+  void search(const Leaf& leaf);
+private:
+  // refine partition to an equitable one, returns the number of cells
+  uint refine(Cells& cells) const;
+  void search(Cells cells, Order& path, const Leaf& leaf);
+  // order of vertices for a discrete partition
+  void vertorder(const Cells& cells, Order& vord) const;
+  // automorphism from two orders of vertices with the same connection vector
+  void add_automorphism(const Order& vord1, const Order& vord2);
+  uint _nverts, _nnodes;
+  // connection, inverse connection (_nverts if none) and matrix node of each vertex
+  Order _conn, _inv, _matof;
+  // first vertex of each matrix and groups of equivalent vertices in each matrix
+  Order _start;
+  std::vector< std::vector<Order> > _groups;
+  // matrices of each class of equivalent matrices
+  std::vector<Order> _classmats;
+  std::vector<bool> _moved;
+  // set of allowed permutations of each vertex (-1 if none)
+  std::vector<int> _permset;
+  // initial colors (for the matrix nodes: sorted by the colors of the vertices)
+  Order _color;
+  // connection vectors of the leaves and the corresponding orders of vertices
+  std::map<Order,Order> _leaves;
+  // automorphisms of the nodes
+  std::vector<Order> _automs;
+};
+
+VertexGraph::VertexGraph(const Order& vertconn, const Product<Matrix>& mats, const Order& matsord,
+                         const Equivalents& equivs, const PermVertices& eqperms)
+ : _nverts(vertconn.size()), _nnodes(vertconn.size()+matsord.size()), _conn(vertconn),
+   _inv(vertconn.size(),vertconn.size()), _matof(vertconn.size()), _moved(vertconn.size(),false),
+   _permset(vertconn.size(),-1)
+{
+  for ( uint is = 0; is < eqperms.size(); ++is )
+    for ( uint pv: eqperms[is] )
+      _permset[pv] = is;
+  for ( uint v = 0; v < _nverts; ++v )
+    if ( _conn[v] < _nverts ) _inv[_conn[v]] = v;
+  uint currvert = 0;
+  for ( uint k = 0; k < matsord.size(); ++k ){
+    _start.push_back(currvert);
+    currvert += mats[matsord[k]].nvertices();
+    for ( uint v = _start.back(); v < currvert; ++v )
+      _matof[v] = _nverts+k;
+  }
+  assert( currvert == _nverts );
+  // classes of equivalent matrices and (smallest) equivalent vertex for each vertex
+  std::vector<int> matclass(matsord.size(),-1);
+  Order equivert;
+  equivert.identity(_nverts);
+  for ( const EquiVertices& ev: equivs ){
+    assert( ev.size() > 1 );
+    if ( _matof[ev[0].front()] != _matof[ev[1].front()] ) {
+      // equivalent matrices
+      _classmats.push_back(Order());
+      for ( const JointVertices& jv: ev ){
+        uint k = _matof[jv.front()]-_nverts;
+        matclass[k] = _classmats.size()-1;
+        _classmats.back().push_back(k);
+        for ( uint v: jv ) _moved[v] = true;
+      }
+    } else {
+      uint vmin = _nverts;
+      for ( const JointVertices& jv: ev )
+        vmin = std::min(vmin,jv.front());
+      for ( const JointVertices& jv: ev ){
+        equivert[jv.front()] = vmin;
+        _moved[jv.front()] = true;
+      }
+    }
+  }
+  // groups of equivalent vertices in each matrix and initial colors
+  std::vector< std::array<uint,3> > keys(_nnodes);
+  _groups.resize(matsord.size());
+  for ( uint k = 0; k < matsord.size(); ++k ){
+    uint end = ( k+1 < matsord.size() ? _start[k+1] : _nverts );
+    for ( uint v = _start[k]; v < end; ++v ){
+      uint ig = 0;
+      while ( ig < _groups[k].size() && _groups[k][ig].front() != equivert[v] ) ++ig;
+      if ( ig == _groups[k].size() )
+        _groups[k].push_back(Order());
+      _groups[k][ig].push_back(v);
+      if ( matclass[k] >= 0 )
+        keys[v] = {1,uint(matclass[k]),equivert[v]-_start[k]};
+      else if ( _permset[v] >= 0 )
+        keys[v] = {5,uint(_permset[v]),0};
+      else
+        keys[v] = {2,equivert[v],0};
+    }
+    if ( matclass[k] >= 0 )
+      keys[_nverts+k] = {3,uint(matclass[k]),0};
+    else
+      keys[_nverts+k] = {4,k,0};
+  }
+  std::vector< std::array<uint,3> > sortkeys(keys);
+  std::sort(sortkeys.begin(),sortkeys.end());
+  sortkeys.erase(std::unique(sortkeys.begin(),sortkeys.end()),sortkeys.end());
+  _color.resize(_nnodes);
+  for ( uint n = 0; n < _nnodes; ++n )
+    _color[n] = std::lower_bound(sortkeys.begin(),sortkeys.end(),keys[n])-sortkeys.begin();
+}
+
+uint VertexGraph::refine(Cells& cells) const
+{
+  uint ncells = *std::max_element(cells.begin(),cells.end())+1;
+  std::vector< std::pair<Order,uint> > sigs(_nnodes);
+  Order matsig;
+  while ( ncells < _nnodes ) {
+    // lines to and from the vertices of allowed permutations are marked by the set
+    auto linecell = [&](uint v){ return v >= _nverts ? 0 : _permset[v] >= 0 ? _nnodes+1+_permset[v] : cells[v]+1; };
+    for ( uint v = 0; v < _nverts; ++v ){
+      Order& sig = sigs[v].first;
+      if ( _permset[v] >= 0 )
+        sig.assign(1,cells[v]);
+      else
+        sig.assign({cells[v], linecell(_conn[v]), linecell(_inv[v]), cells[_matof[v]]});
+      sigs[v].second = v;
+    }
+    for ( uint k = 0; k < _groups.size(); ++k ){
+      Order& sig = sigs[_nverts+k].first;
+      sig.assign(1,cells[_nverts+k]);
+      // cells of the vertices, in each group of equivalent vertices sorted
+      for ( const Order& grp: _groups[k] ){
+        matsig.clear();
+        for ( uint v: grp ) matsig.push_back(cells[v]);
+        std::sort(matsig.begin(),matsig.end());
+        sig.insert(sig.end(),matsig.begin(),matsig.end());
+      }
+      sigs[_nverts+k].second = _nverts+k;
+    }
+    std::sort(sigs.begin(),sigs.end());
+    uint nnew = 0;
+    for ( uint i = 0; i < _nnodes; ++i ){
+      if ( i > 0 && sigs[i].first != sigs[i-1].first ) ++nnew;
+      cells[sigs[i].second] = nnew;
+    }
+    ++nnew;
+    if ( nnew == ncells ) break;
+    ncells = nnew;
+  }
+  return ncells;
+}
+
+void VertexGraph::vertorder(const Cells& cells, Order& vord) const
+{
+  vord.resize(_nverts+1);
+  vord[_nverts] = _nverts;
+  // equivalent matrices go to the places of the matrices in the class (in the order of cells)
+  Order target;
+  target.identity(_groups.size());
+  Order sorted;
+  for ( const Order& cmats: _classmats ){
+    sorted = cmats;
+    std::sort(sorted.begin(),sorted.end(),[&](uint k1, uint k2){ return cells[_nverts+k1] < cells[_nverts+k2]; });
+    for ( uint i = 0; i < cmats.size(); ++i )
+      target[sorted[i]] = cmats[i];
+  }
+  // equivalent vertices go to the places of the group (in the order of cells)
+  for ( uint k = 0; k < _groups.size(); ++k ){
+    for ( const Order& grp: _groups[k] ){
+      sorted = grp;
+      std::sort(sorted.begin(),sorted.end(),[&cells](uint v1, uint v2){ return cells[v1] < cells[v2]; });
+      for ( uint i = 0; i < grp.size(); ++i )
+        vord[sorted[i]] = grp[i]-_start[k]+_start[target[k]];
+    }
+  }
+}
+
+void VertexGraph::add_automorphism(const Order& vord1, const Order& vord2)
+{
+  // vertex at the place of v in the other order
+  Order vert1(_nverts);
+  for ( uint v = 0; v < _nverts; ++v )
+    vert1[vord1[v]] = v;
+  Order autom(_nnodes);
+  for ( uint v = 0; v < _nverts; ++v )
+    autom[v] = vert1[vord2[v]];
+  for ( uint k = 0; k < _groups.size(); ++k ){
+    uint k1 = _nverts+k;
+    if ( !_groups[k].empty() ) k1 = _matof[autom[_groups[k].front().front()]];
+    autom[_nverts+k] = k1;
+  }
+  _automs.push_back(autom);
+}
+
+void VertexGraph::search(const Leaf& leaf)
+{
+  Order path;
+  search(_color,path,leaf);
+}
+
+void VertexGraph::search(Cells cells, Order& path, const Leaf& leaf)
+{
+  uint ncells = refine(cells);
+  // first non-trivial cell (vertices of allowed permutations are not individualized)
+  Order ncell(ncells,0);
+  for ( uint n = 0; n < _nnodes; ++n )
+    if ( n >= _nverts || _permset[n] < 0 ) ++ncell[cells[n]];
+  uint target = 0;
+  while ( target < ncells && ncell[target] < 2 ) ++target;
+  if ( target == ncells ) {
+    Order vord, connections(_nverts);
+    vertorder(cells,vord);
+    for ( uint i = 0; i < _nverts; ++i )
+      connections[vord[i]] = vord[_conn[i]];
+    auto ins = _leaves.insert(std::make_pair(connections,vord));
+    if ( ins.second )
+      leaf(vord,connections);
+    else
+      add_automorphism(ins.first->second,vord);
+    return;
+  }
+  Order explored, orbit;
+  for ( uint x = 0; x < _nnodes; ++x ){
+    if ( cells[x] != target ) continue;
+    if ( !explored.empty() ) {
+      // skip x if it is in the orbit of an explored node (automorphisms which fix the path)
+      orbit.identity(_nnodes);
+      std::function<uint(uint)> root = [&orbit,&root](uint n){ return orbit[n] == n ? n : orbit[n] = root(orbit[n]); };
+      for ( const Order& autom: _automs ){
+        bool fixed = true;
+        for ( uint n: path ) fixed = fixed && autom[n] == n;
+        if ( !fixed ) continue;
+        for ( uint n = 0; n < _nnodes; ++n )
+          orbit[root(n)] = root(autom[n]);
+      }
+      bool skip = false;
+      for ( uint y: explored ) skip = skip || root(y) == root(x);
+      if ( skip ) continue;
+    }
+    explored.push_back(x);
+    // individualize x
+    Cells xcells(cells);
+    for ( uint n = 0; n < _nnodes; ++n )
+      if ( cells[n] > target || ( cells[n] == target && n != x ) ) ++xcells[n];
+    path.push_back(x);
+    search(xcells,path,leaf);
+    path.pop_back();
+  }
+}
+
+}
 
 UniGraph::UniGraph(const Term& term) : _sign(1)
 {
-  int permuteq = Input::iPars["prog"]["permuteq"];
+  int permuteq = Input::config.permuteq;
   pTerm = &term;
   const Product<Matrix> & mats = term.mat();
   for ( uint i = 0; i < mats.size(); ++i )
@@ -125,6 +393,20 @@ bool UniGraph::is_equal(const UniGraph& ug) const
 
 }
 
+uint64_t UniGraph::hashkey() const
+{
+  uint64_t key = _matsord.size();
+  auto add = [&key](uint64_t h){ key = (key ^ h) * 0x100000001B3ull + (key >> 29); };
+  const Product<Matrix>& mats = pTerm->mat();
+  for (const auto& im: _matsord)
+    add(mats[im].equivkey());
+  for (const auto& ot: _orbtypes)
+    add(ot);
+  for (const auto& ic: _vertconn)
+    add(ic);
+  return key;
+}
+
 Product< Matrix > UniGraph::ordmats() const
 {
   Product<Matrix> mats;
@@ -192,7 +474,60 @@ void UniGraph::gen_perms(const PermVertices& from, const PermVertices& to,
 
 void UniGraph::minimize()
 {
-  int permuteq = Input::iPars["prog"]["permuteq"];
+  if ( Input::config.eqcache <= 0 ) {
+    minimize_connections();
+    return;
+  }
+  std::string key(cachekey());
+  UniGraphCache::Entry entry;
+  if ( UniGraphCache::find(key,entry) ) {
+    _vertconn = entry.vertconn;
+    _perms = entry.perms;
+    _sign = entry.sign;
+    return;
+  }
+  minimize_connections();
+  entry.vertconn = _vertconn;
+  entry.perms = _perms;
+  entry.sign = _sign;
+  UniGraphCache::add(key,entry);
+}
+
+std::string UniGraph::cachekey() const
+{
+  std::ostringstream key;
+  const Input::Config& c = Input::config;
+  key << c.permuteq << " " << c.eqcanon << " " << c.eqprune << " |";
+  for ( uint ic: _vertconn )
+    key << " " << ic;
+  key << " |";
+  for ( const EquiVertices& eqv: _equivs ) {
+    key << " " << eqv.size() << ":";
+    for ( const JointVertices& jv: eqv )
+      for ( uint v: jv )
+        key << " " << v;
+  }
+  key << " |";
+  for ( const PermVertices* pvs: {&_eqperms,&_eqperm_from} ) {
+    for ( const JointVertices& pv: *pvs ) {
+      key << " " << pv.sign << ":";
+      for ( uint v: pv )
+        key << " " << v;
+    }
+    key << " |";
+  }
+  if ( c.eqcanon > 0 ) {
+    // the canonical labelling distinguishes the matrices
+    const Product<Matrix>& mats = pTerm->mat();
+    for ( uint im: _matsord )
+      key << " " << mats[im].equivkey();
+  }
+  return key.str();
+}
+
+void UniGraph::minimize_connections()
+{
+  int permuteq = Input::config.permuteq;
   bool permute4each_vertorder = (permuteq > 1);
   // order of vertices, i.e., where is the vertex i
   Order vertorder;
@@ -209,48 +544,152 @@ void UniGraph::minimize()
     min_perms;
   short
     min_sign = 1;
-  if (permute4each_vertorder) {
-    // allowed permutations
-    apply_eqperms(connections,vertorder,eq_perms,eq_perm_from,eq_perm_from_orig);
-    min_eq_perms = eq_perms;
-    min_eq_perm_from = eq_perm_from;
-    min_perms = _perms;
-    min_sign = _sign;
-  }
-  Order minconn(connections);
-  bool nextperm;
-//   uint minorder = 0, iord = 0;
-  do {
-    // next permutation of ieqv'th equivalent vertices
-    nextperm = false;
-    for ( uint ieqv = 0; ieqv < _equivs.size() && !nextperm; ++ieqv ) {
-      nextperm = _equivs[ieqv].next_permutation(vertorder);
+  if ( Input::config.eqcanon > 0 ) {
+    VertexGraph graph(_vertconn,pTerm->mat(),_matsord,_equivs,_eqperms);
+    // the allowed permutations have to stay in place for the canonical labelling
+    bool fixedperms = true;
+    for ( const JointVertices& pvs: _eqperms )
+      for ( uint pv: pvs )
+        fixedperms = fixedperms && !graph.moved()[pv];
+    if ( fixedperms ) {
+      bool first = true;
+      Order minconn;
+      graph.search([&](const Order& vord, const Order& conns){
+        connections = conns;
+        if (permute4each_vertorder) {
+          apply_eqperms(connections,vord,eq_perms,eq_perm_from,eq_perm_from_orig);
+          if ( first || connections < minconn || ( connections == minconn && _perms < min_perms ) ) {
+            min_perms = _perms;
+            min_sign = _sign;
+            minconn = connections;
+          }
+        } else if ( first || connections < minconn ) {
+          minconn = connections;
+          minvertorder = vord;
+        }
+        first = false;
+      });
+      if ( !permute4each_vertorder ) {
+        apply_eqperms(minconn,minvertorder,eq_perms,eq_perm_from,eq_perm_from_orig);
+      } else {
+        _perms = min_perms;
+        _sign = min_sign;
+      }
+      _vertconn = minconn;
+      return;
+    }
+  }
+  Order minconn;
+  if ( Input::config.eqprune > 0 ) {
+    // search tree of the orders of vertices: level k permutes _equivs[k-1], the leaves are visited
+    // in the same order as in the enumeration below (the first minimum is the same)
+    const uint nverts = _vertconn.size();
+    // vertices which are still permuted below level k
+    std::vector< std::vector<bool> > freeverts(_equivs.size()+1,std::vector<bool>(nverts,false));
+    for ( uint k = 1; k <= _equivs.size(); ++k ) {
+      freeverts[k] = freeverts[k-1];
+      for ( const JointVertices& jv: _equivs[k-1] )
+        for ( uint v: jv )
+          freeverts[k][v] = true;
     }
-    if ( nextperm ) {
-      // create new connection vector and compare to the old one
-      for ( uint i = 0; i < _vertconn.size(); ++i )
+    // positions and vertices which can be moved by the allowed permutations
+    std::vector<bool> permpos(nverts,false), fromvert(nverts,false);
+    if (permute4each_vertorder) {
+      for ( const JointVertices& pvs: _eqperms )
+        for ( uint pv: pvs )
+          permpos[pv] = true;
+      for ( const JointVertices& pvs: _eqperm_from )
+        for ( uint pv: pvs )
+          fromvert[pv] = true;
+    }
+    Order invorder(nverts);
+    // compare the part of the connection vector which is fixed on level k with minconn
+    // (> 0: all orders in the subtree have larger connection vectors)
+    auto cmpprefix = [&](uint k) -> int {
+      for ( uint i = 0; i < nverts; ++i )
+        invorder[vertorder[i]] = i;
+      const std::vector<bool>& free = freeverts[k];
+      for ( uint p = 0; p < nverts; ++p ) {
+        uint v = invorder[p], t = _vertconn[v];
+        if ( permpos[p] || fromvert[v] || free[v] || ( t < nverts && free[t] ) ) return 0;
+        if ( vertorder[t] < minconn[p] ) return -1;
+        if ( minconn[p] < vertorder[t] ) return 1;
+      }
+      return 0;
+    };
+    bool first = true;
+    std::function<void(uint)> search = [&](uint k){
+      int cmp = first ? -1 : cmpprefix(k);
+      if ( cmp > 0 ) return;
+      if ( k > 0 ) {
+        do {
+          search(k-1);
+        } while ( _equivs[k-1].next_permutation(vertorder) );
+        return;
+      }
+      if ( !permute4each_vertorder && cmp == 0 ) return;
+      for ( uint i = 0; i < nverts; ++i )
         connections[vertorder[i]] = vertorder[_vertconn[i]];
-//       xout << "before permut " << vertorder << " --> " << connections << std::endl;
       if (permute4each_vertorder) {
-        // allowed permutations
+        // allowed permutations (only for the orders which can still be minimal)
         apply_eqperms(connections,vertorder,eq_perms,eq_perm_from,eq_perm_from_orig);
-//         xout << eq_perms << " " << eq_perm_from << " " << std::endl;
-        if ( connections < minconn || ( connections == minconn && _perms < min_perms ) ) {
-            // replace equal connection only if the new one has less permutations
-          min_eq_perms = eq_perms;
-          min_eq_perm_from = eq_perm_from;
+        if ( first || connections < minconn || ( connections == minconn && _perms < min_perms ) ) {
           min_perms = _perms;
           min_sign = _sign;
           minconn = connections;
           minvertorder = vertorder;
         }
-      } else if ( connections < minconn ) {
+      } else {
         minconn = connections;
         minvertorder = vertorder;
       }
-//       xout << vertorder << " --> " << connections << std::endl;
+      first = false;
+    };
+    search(_equivs.size());
+  } else {
+    if (permute4each_vertorder) {
+      // allowed permutations
+      apply_eqperms(connections,vertorder,eq_perms,eq_perm_from,eq_perm_from_orig);
+      min_eq_perms = eq_perms;
+      min_eq_perm_from = eq_perm_from;
+      min_perms = _perms;
+      min_sign = _sign;
     }
-  } while (nextperm);
+    minconn = connections;
+    bool nextperm;
+//   uint minorder = 0, iord = 0;
+    do {
+      // next permutation of ieqv'th equivalent vertices
+      nextperm = false;
+      for ( uint ieqv = 0; ieqv < _equivs.size() && !nextperm; ++ieqv ) {
+        nextperm = _equivs[ieqv].next_permutation(vertorder);
+      }
+      if ( nextperm ) {
+        // create new connection vector and compare to the old one
+        for ( uint i = 0; i < _vertconn.size(); ++i )
+          connections[vertorder[i]] = vertorder[_vertconn[i]];
+//       xout << "before permut " << vertorder << " --> " << connections << std::endl;
+        if (permute4each_vertorder) {
+          // allowed permutations
+          apply_eqperms(connections,vertorder,eq_perms,eq_perm_from,eq_perm_from_orig);
+//         xout << eq_perms << " " << eq_perm_from << " " << std::endl;
+          if ( connections < minconn || ( connections == minconn && _perms < min_perms ) ) {
+              // replace equal connection only if the new one has less permutations
+            min_eq_perms = eq_perms;
+            min_eq_perm_from = eq_perm_from;
+            min_perms = _perms;
+            min_sign = _sign;
+            minconn = connections;
+            minvertorder = vertorder;
+          }
+        } else if ( connections < minconn ) {
+          minconn = connections;
+          minvertorder = vertorder;
+        }
+//       xout << vertorder << " --> " << connections << std::endl;
+      }
+    } while (nextperm);
+  }
   if ( !permute4each_vertorder ) {
     // try to minimize further by using allowed permutations
     apply_eqperms(minconn,minvertorder,eq_perms,eq_perm_from,eq_perm_from_orig);
@@ -273,6 +712,67 @@ void UniGraph::minimize()
 //   }
 }
 
+std::mutex UniGraphCache::_mtx;
+std::unordered_map<std::string,UniGraphCache::Entry> UniGraphCache::_entries;
+
+bool UniGraphCache::find(const std::string& key, Entry& entry)
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+  auto it = _entries.find(key);
+  if ( it == _entries.end() ) return false;
+  entry = it->second;
+  return true;
+}
+
+void UniGraphCache::add(const std::string& key, const Entry& entry)
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+  _entries.emplace(key,entry);
+}
+
+// file format: one entry per line
+// key ; connections ; permutations (pairs) ; sign
+void UniGraphCache::load(const std::string& file)
+{
+  std::ifstream fin(file.c_str());
+  std::string line, key, conns, perms;
+  uint n = 0;
+  while ( std::getline(fin,line) ) {
+    std::istringstream sline(line);
+    Entry entry;
+    if ( !std::getline(sline,key,';') || !std::getline(sline,conns,';') ||
+         !std::getline(sline,perms,';') || !(sline >> entry.sign) ) {
+      say("Bad line in "+file+": "+line,"UniGraphCache::load");
+      continue;
+    }
+    std::istringstream sconns(conns), sperms(perms);
+    uint i1, i2;
+    while ( sconns >> i1 )
+      entry.vertconn.push_back(i1);
+    while ( sperms >> i1 >> i2 )
+      entry.perms[i1] = i2;
+    add(key,entry);
+    ++n;
+  }
+  if ( n > 0 ) say("Read "+any2str(n)+" minimized graphs from "+file);
+}
+
+void UniGraphCache::save(const std::string& file)
+{
+  std::lock_guard<std::mutex> lock(_mtx);
+  if ( _entries.empty() ) return;
+  std::ofstream fout(file.c_str());
+  for ( const auto& ent: _entries ) {
+    fout << ent.first << ";";
+    for ( uint ic: ent.second.vertconn )
+      fout << " " << ic;
+    fout << " ;";
+    for ( const auto& perm: ent.second.perms )
+      fout << " " << perm.first << " " << perm.second;
+    fout << " ; " << ent.second.sign << std::endl;
+  }
+}
+
 std::pair<Permut,TFactor> UniGraph::permutation(const UniGraph& ug) const
 {
   assert( ug._neworbs.size() == _vertconn.size() );
@@ -5,6 +5,9 @@
 
 #include <vector>
 #include <list>
+#include <string>
+#include <mutex>
+#include <unordered_map>
 #include "types.h"
 #include "globals.h"
 #include "term.h"
@@ -39,11 +42,18 @@ public:
   const PermVertices& eqperm_from() const { return _eqperm_from;};
   // check equality of two graphs
   bool is_equal(const UniGraph& ug) const;
+  // hash of everything compared in is_equal (call after minimize)
+  uint64_t hashkey() const;
   // search for the minimal _vertconn using _equivs and _eqperms
+  // (the result is taken from UniGraphCache if eqcache > 0)
   void minimize();
   // generate permutation using orbitals from ug (have to be generated before!)
   std::pair<Permut,TFactor> permutation( const UniGraph& ug ) const;
 private:
+  // the search in minimize
+  void minimize_connections();
+  // everything minimize depends on (key for UniGraphCache)
+  std::string cachekey() const;
   // apply permutations to minimize the connections-vector further
   // calls gen_perms to set _perms
   void apply_eqperms(Order& connections, const Order& vertorder,
@@ -79,6 +89,26 @@ private:
   const Term * pTerm;
 };
 
+/// Minimized connection vectors and permutations of UniGraphs for the whole run
+/// (shared between the equations and threads), optionally saved to a file for the next runs
+class UniGraphCache {
+public:
+  struct Entry {
+    Order vertconn;
+    Permutation perms;
+    short sign;
+  };
+  static bool find(const std::string& key, Entry& entry);
+  static void add(const std::string& key, const Entry& entry);
+  // read entries from file (if it exists)
+  static void load(const std::string& file);
+  // write all entries to file (no file without entries, e.g., for eqway=0)
+  static void save(const std::string& file);
+private:
+  static std::mutex _mtx;
+  static std::unordered_map<std::string,Entry> _entries;
+};
+
 std::ostream & operator << (std::ostream & o, const UniGraph& ug);
 
 #endif
\ No newline at end of file
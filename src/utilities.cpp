@@ -2,6 +2,9 @@
 #ifdef _WIN32
 #include <windows.h>
 #endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
 void error(std::string what, std::string where)
 {
   std::cerr << "  ERROR: " << what << std::endl;
@@ -15,6 +18,13 @@ void say(std::string what, std::string where)
   if (where.size() > 0)
     _xout0("  in " << where << std::endl);
 }
+void releasememory()
+{
+#ifdef __GLIBC__
+  // the arenas of the worker threads are not reused by the main thread
+  malloc_trim(0);
+#endif
+}
 std::string exepath(){
   std::string path;
   char buff[1024];
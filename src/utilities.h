@@ -32,6 +32,9 @@ void say(std::string what, std::string where="");
 // path of executable
 std::string exepath();
 
+// return the freed memory of all malloc arenas to the system (e.g., after a multithreaded part)
+void releasememory();
+
 // return true if file exists, false otherwise
 bool exists(const std::string& filepath);
 
@@ -0,0 +1,378 @@
+#include "wick.h"
+
+thread_local WickContractor::Cache WickContractor::_cache;
+
+WickContractor::WickContractor(const Product<SQOp>& ops, const std::list< std::list<int> >& groups, bool genw)
+ : _nops(ops.size()), _genw(genw), _qcreators(0), _dmops(0), _qcfixed(0), _qafixed(0),
+   _usememo(genw && Input::config.wickmemo > 0), _nkrons(0), _dmpos(0), _parity(0), _sink(0),
+   _record(0)
+{
+  if ( _nops > maxops ) error("Too many SQ operators for Wick's theorem","WickContractor");
+  for ( uint t = 0; t < Orbital::MaxType; ++t )
+    _cre[t] = _ann[t] = 0;
+  // SQops in the same normal ordered group
+  Mask groupmask[maxops];
+  unsigned char groupindx[maxops];
+  unsigned char igrp = 0;
+  for ( const auto& grp: groups ) {
+    Mask gm = 0;
+    for ( int i: grp ) gm |= bit(i);
+    for ( int i: grp ) {
+      groupmask[i] = gm;
+      groupindx[i] = igrp;
+    }
+    ++igrp;
+  }
+  _layout.push_back(char(genw));
+  for ( uint i = 0; i < _nops; ++i ) {
+    const SQOp& opi = ops[i];
+    Orbital::Type orbtypei = opi.orb().type();
+    _layout.push_back(char(opi.gender() | opi.genderPH() << 2 | orbtypei << 4));
+    _layout.push_back(char(groupindx[i]));
+    if ( opi.genderPH() == SQOpT::Creator ) _qcreators |= bit(i);
+    if ( orbtypei == Orbital::GenT || orbtypei == Orbital::Act ) _dmops |= bit(i);
+    if ( opi.gender() == SQOpT::Creator )
+      _cre[orbtypei] |= bit(i);
+    else
+      _ann[orbtypei] |= bit(i);
+    if ( opi.genderPH() == SQOpT::Creator )
+      _qcfixed |= bit(i);
+    else if ( opi.genderPH() == SQOpT::Annihilator )
+      _qafixed |= bit(i);
+    _compat[i] = 0;
+    for ( uint j = i+1; j < _nops; ++j ) {
+      if ( groupmask[i] & bit(j) ) continue;
+      const SQOp& opj = ops[j];
+      Orbital::Type orbtypej = opj.orb().type();
+      if ( opj.gender() != opi.gender() && opj.genderPH() != SQOpT::Annihilator &&
+           ( orbtypei == Orbital::GenT || orbtypej == orbtypei || orbtypej == Orbital::GenT ) )
+        _compat[i] |= bit(j);
+    }
+  }
+}
+
+void WickContractor::set_connected(const std::vector<Mask>& opmats, const std::vector<Mask>& matadj,
+                                   const std::vector<Mask>& groups)
+{
+  assert( opmats.size() == _nops );
+  if ( matadj.size() > maxops ) return;
+  for ( uint i = 0; i < _nops; ++i )
+    _opmats[i] = opmats[i];
+  _matadj = matadj;
+  _conngroups = groups;
+}
+
+void WickContractor::set_symmetry(const std::vector<Perm>& perms)
+{
+  assert( !_genw );
+  if ( perms.size() > 1 ) _symperms = perms;
+}
+
+std::string WickContractor::layout() const
+{
+  std::string key(_layout);
+  auto addmask = [&key](Mask mask){ key.append(reinterpret_cast<const char*>(&mask),sizeof(Mask)); };
+  if ( !_conngroups.empty() ) {
+    for ( uint i = 0; i < _nops; ++i ) addmask(_opmats[i]);
+    key.push_back(char(_matadj.size()));
+    for ( Mask m: _matadj ) addmask(m);
+    key.push_back(char(_conngroups.size()));
+    for ( Mask m: _conngroups ) addmask(m);
+  }
+  for ( const Perm& perm: _symperms )
+    for ( uint i: perm ) key.push_back(char(i));
+  return key;
+}
+
+void WickContractor::contract(const Sink& sink)
+{
+  _sink = &sink;
+  _nkrons = 0;
+  _dmpos = _nops;
+  _parity = 0;
+  if ( Input::config.wickcache > 0 ) {
+    std::string key(layout());
+    Cache::const_iterator it = _cache.find(key);
+    if ( it != _cache.end() ) {
+      // the contractions of this layout are known already
+      const unsigned char * idx = it->second.idx.data();
+      for ( const auto& entry: it->second.entries ) {
+        for ( uint k = 0; k < 2u*entry.nkrons; ++k ) _krons[k] = *idx++;
+        for ( uint k = 0; k < entry.ndm; ++k ) _dm[k] = *idx++;
+        WickContraction contr = { _krons, entry.nkrons, _dm, entry.ndm, entry.sign, entry.weight };
+        sink(contr);
+      }
+      _sink = 0;
+      return;
+    }
+    _record = &_cache[key];
+  }
+  Mask all = ( _nops == maxops ? ~Mask(0) : bit(_nops) - 1 );
+  if ( _usememo ) {
+    if ( memoize(all) ) replay(all);
+    _memo.clear();
+  } else
+    contract(all);
+  _sink = 0;
+  _record = 0;
+}
+
+void WickContractor::emit()
+{
+  WickContraction contr;
+  contr.weight = 1;
+  if ( !_symperms.empty() && (contr.weight = canonical()) == 0 ) return;
+  contr.krons = _krons;
+  contr.nkrons = _nkrons/2;
+  contr.dm = _dm + _dmpos;
+  contr.ndm = _nops - _dmpos;
+  contr.sign = ( _parity ? -1 : 1 );
+  if ( _record ) {
+    Contractions::Entry entry = { (unsigned char)contr.nkrons, (unsigned char)contr.ndm,
+                                  (signed char)contr.sign, contr.weight };
+    _record->entries.push_back(entry);
+    _record->idx.insert(_record->idx.end(),contr.krons,contr.krons+2*contr.nkrons);
+    _record->idx.insert(_record->idx.end(),contr.dm,contr.dm+contr.ndm);
+  }
+  (*_sink)(contr);
+}
+
+uint WickContractor::canonical() const
+{
+  // partner of each SQop in the current contraction
+  uint partner[maxops], mapped[maxops];
+  for ( uint k = 0; k < _nkrons; k += 2 ) {
+    partner[_krons[k]] = _krons[k+1];
+    partner[_krons[k+1]] = _krons[k];
+  }
+  // the canonical contraction has the lexicographically smallest partner list in its orbit
+  uint nstab = 0;
+  for ( const Perm& perm: _symperms ) {
+    for ( uint i = 0; i < _nops; ++i )
+      mapped[perm[i]] = perm[partner[i]];
+    uint i = 0;
+    while ( i < _nops && mapped[i] == partner[i] ) ++i;
+    if ( i == _nops )
+      ++nstab;
+    else if ( mapped[i] < partner[i] )
+      return 0;
+  }
+  // orbit size
+  assert( nstab > 0 && _symperms.size()%nstab == 0 );
+  return _symperms.size()/nstab;
+}
+
+bool WickContractor::canonicalizable(Mask remaining) const
+{
+  // partner of each contracted SQop
+  uint partner[maxops], mapped[maxops];
+  Mask known = ~remaining;
+  if ( _nops < maxops ) known &= bit(_nops) - 1;
+  for ( uint k = 0; k < _nkrons; k += 2 ) {
+    partner[_krons[k]] = _krons[k+1];
+    partner[_krons[k+1]] = _krons[k];
+  }
+  // every completion is non-canonical if a permutation already gives a smaller partner list
+  // on a prefix which is known in both lists
+  for ( const Perm& perm: _symperms ) {
+    Mask mknown = 0;
+    for ( Mask kn = known; kn; kn &= kn-1 ) {
+      uint i = __builtin_ctzll(kn);
+      mapped[perm[i]] = perm[partner[i]];
+      mknown |= bit(perm[i]);
+    }
+    Mask both = known & mknown;
+    for ( uint i = 0; i < _nops && (both & bit(i)); ++i ) {
+      if ( mapped[i] == partner[i] ) continue;
+      if ( mapped[i] < partner[i] ) return false;
+      break;
+    }
+  }
+  return true;
+}
+
+void WickContractor::contract(Mask remaining)
+{
+  if ( remaining == 0 ) { // no SQoperators left
+    emit();
+    return;
+  }
+  uint curr = __builtin_ctzll(remaining);
+  // quasi-Creator on the left --> this term is zero
+  if ( _qcreators & bit(curr) ) return;
+  if ( !feasible(remaining) ) return;
+  if ( !_conngroups.empty() && !connectable(remaining) ) return;
+  if ( !_symperms.empty() && !canonicalizable(remaining) ) return;
+  remaining &= ~bit(curr);
+  _krons[_nkrons] = curr;
+  _nkrons += 2;
+  for ( Mask cand = remaining & _compat[curr]; cand; cand &= cand-1 ) {
+    uint partner = __builtin_ctzll(cand);
+    // sign from the number of SQops between curr and partner
+    uint flip = __builtin_popcountll(remaining & (bit(partner)-1)) & 1;
+    _krons[_nkrons-1] = partner;
+    _parity ^= flip;
+    contract(remaining & ~bit(partner));
+    _parity ^= flip;
+  }
+  _nkrons -= 2;
+  if ( _genw && (_dmops & bit(curr)) ) {
+    // add to the density matrix
+    uint flip = __builtin_popcountll(remaining) & 1;
+    _dm[--_dmpos] = curr;
+    _parity ^= flip;
+    contract(remaining);
+    _parity ^= flip;
+    ++_dmpos;
+  }
+}
+
+bool WickContractor::memoize(Mask remaining)
+{
+  if ( remaining == 0 ) return true;
+  auto it = _memo.find(remaining);
+  if ( it != _memo.end() ) return !it->second.empty();
+  std::vector<Step> steps;
+  uint curr = __builtin_ctzll(remaining);
+  if ( !(_qcreators & bit(curr)) && feasible(remaining) ) {
+    Mask rem = remaining & ~bit(curr);
+    for ( Mask cand = rem & _compat[curr]; cand; cand &= cand-1 ) {
+      uint partner = __builtin_ctzll(cand);
+      Step step = { (unsigned char)curr, (unsigned char)partner,
+                    (unsigned char)(__builtin_popcountll(rem & (bit(partner)-1)) & 1),
+                    rem & ~bit(partner) };
+      if ( memoize(step.remaining) ) steps.push_back(step);
+    }
+    if ( _dmops & bit(curr) ) {
+      Step step = { (unsigned char)curr, dmstep,
+                    (unsigned char)(__builtin_popcountll(rem) & 1), rem };
+      if ( memoize(step.remaining) ) steps.push_back(step);
+    }
+  }
+  bool alive = !steps.empty();
+  _memo[remaining].swap(steps);
+  return alive;
+}
+
+void WickContractor::replay(Mask remaining)
+{
+  if ( remaining == 0 ) {
+    emit();
+    return;
+  }
+  // the connections depend on the contractions made so far
+  if ( !_conngroups.empty() && !connectable(remaining) ) return;
+  for ( const Step& step: _memo.find(remaining)->second ) {
+    _parity ^= step.flip;
+    if ( step.op2 == dmstep ) {
+      _dm[--_dmpos] = step.op1;
+      replay(step.remaining);
+      ++_dmpos;
+    } else {
+      _krons[_nkrons] = step.op1;
+      _krons[_nkrons+1] = step.op2;
+      _nkrons += 2;
+      replay(step.remaining);
+      _nkrons -= 2;
+    }
+    _parity ^= step.flip;
+  }
+}
+
+bool WickContractor::feasible(Mask remaining) const
+{
+  // number of general creators and annihilators needed as partners
+  uint needcre = 0, needann = 0;
+  for ( uint t = 0; t < Orbital::MaxType; ++t ) {
+    if ( t == Orbital::GenT || (t == Orbital::Act && _genw) ) continue;
+    int diff = __builtin_popcountll(remaining & _cre[t]) - __builtin_popcountll(remaining & _ann[t]);
+    if ( diff > 0 )
+      needann += diff;
+    else
+      needcre -= diff;
+  }
+  Mask gencre = remaining & _cre[Orbital::GenT], genann = remaining & _ann[Orbital::GenT];
+  if ( needcre > uint(__builtin_popcountll(gencre)) || needann > uint(__builtin_popcountll(genann)) )
+    return false;
+  // quasi-creators need a partner on the left, quasi-annihilators on the right:
+  // check all prefixes ending with a quasi-creator and suffixes starting with a quasi-annihilator
+  Mask qc = remaining & _qcfixed, qa = remaining & _qafixed;
+  for ( Mask mm = qc | qa; mm; mm &= mm-1 ) {
+    uint k = __builtin_ctzll(mm);
+    // SQops in part which need a partner in part
+    Mask part, need;
+    if ( qc & bit(k) ) {
+      part = remaining & ((bit(k)<<1)-1);
+      need = qc;
+    } else {
+      part = remaining & ~(bit(k)-1);
+      need = qa;
+    }
+    needcre = needann = 0;
+    for ( uint t = 0; t < Orbital::MaxType; ++t ) {
+      if ( t == Orbital::GenT || t == Orbital::Act ) continue;
+      Mask typ = part & (_cre[t]|_ann[t]);
+      int nunmatched = __builtin_popcountll(typ & need) - __builtin_popcountll(typ & ~need);
+      if ( nunmatched <= 0 ) continue;
+      // unmatched creators need general annihilators and vice versa
+      if ( typ & need & _cre[t] )
+        needann += nunmatched;
+      else
+        needcre += nunmatched;
+    }
+    if ( needcre > uint(__builtin_popcountll(part & gencre)) ||
+         needann > uint(__builtin_popcountll(part & genann)) )
+      return false;
+  }
+  return true;
+}
+
+void WickContractor::connect(Mask * adj, Mask mats)
+{
+  for ( Mask mm = mats; mm; mm &= mm-1 )
+    adj[__builtin_ctzll(mm)] |= mats;
+}
+
+bool WickContractor::connectable(Mask remaining) const
+{
+  // upper bound for the connections between matrices:
+  // connections made so far and every possible contraction of the remaining SQops
+  Mask adj[maxops];
+  uint nmat = _matadj.size();
+  for ( uint m = 0; m < nmat; ++m )
+    adj[m] = _matadj[m];
+  for ( uint k = 0; k < _nkrons; k += 2 )
+    connect(adj,_opmats[_krons[k]]|_opmats[_krons[k+1]]);
+  for ( Mask rem = remaining; rem; rem &= rem-1 ) {
+    uint i = __builtin_ctzll(rem);
+    Mask partners = 0;
+    for ( Mask cand = remaining & _compat[i]; cand; cand &= cand-1 )
+      partners |= _opmats[__builtin_ctzll(cand)];
+    for ( Mask mm = _opmats[i]; mm; mm &= mm-1 )
+      adj[__builtin_ctzll(mm)] |= partners;
+    for ( Mask mm = partners; mm; mm &= mm-1 )
+      adj[__builtin_ctzll(mm)] |= _opmats[i];
+  }
+  if ( _genw ) {
+    // density matrices can be reduced to Kroneckers later on
+    Mask dmmats = 0;
+    for ( Mask rem = remaining & _dmops; rem; rem &= rem-1 )
+      dmmats |= _opmats[__builtin_ctzll(rem)];
+    for ( uint k = _dmpos; k < _nops; ++k )
+      dmmats |= _opmats[_dm[k]];
+    connect(adj,dmmats);
+  }
+  for ( const auto& grp: _conngroups ) {
+    // matrices reachable from the first matrix in the group
+    Mask reached = grp & -grp, front = reached;
+    while ( front ) {
+      Mask next = 0;
+      for ( ; front; front &= front-1 )
+        next |= adj[__builtin_ctzll(front)];
+      front = next & grp & ~reached;
+      reached |= front;
+    }
+    if ( reached != grp ) return false;
+  }
+  return true;
+}
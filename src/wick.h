@@ -0,0 +1,141 @@
+#ifndef WICK_H
+#define WICK_H
+
+#include <list>
+#include <string>
+#include <vector>
+#include <functional>
+#include <unordered_map>
+#include <stdint.h>
+#include "globals.h"
+#include "operators.h"
+
+/*!
+    Implements the enumeration of full contractions (Wick's theorem)
+    of a string of second quantized operators.
+
+    The state is kept in bitmasks of the remaining operators and in fixed-size
+    index arrays, every choice is undone on backtrack.
+*/
+
+//! a full contraction of the operator string (indices in the operator string)
+struct WickContraction {
+  // Kronecker pairs (krons[2i],krons[2i+1])
+  const uint * krons;
+  uint nkrons;
+  // SQops in the density matrix (generalized Wick's theorem)
+  const uint * dm;
+  uint ndm;
+  // sign of the contraction (+1 or -1)
+  int sign;
+  // number of equivalent contractions represented by this one (see WickContractor::set_symmetry)
+  uint weight;
+};
+
+class WickContractor {
+public:
+  typedef uint64_t Mask;
+  typedef std::function<void(const WickContraction&)> Sink;
+  //! permutation of the SQops (new position of SQop i)
+  typedef std::vector<uint> Perm;
+  //! max number of SQops in the operator string
+  static const uint maxops = 64;
+  //! construct from the operator string and the normal ordered groups of SQops
+  //! genw: generalized Wick's theorem (uncontracted GenT and Act SQops go to density matrices)
+  WickContractor(const Product<SQOp>& ops, const std::list< std::list<int> >& groups, bool genw);
+  //! skip contractions which cannot connect the matrices in the groups
+  //! opmats: matrices with the orbital of each SQop, matadj: matrices connected already before contraction
+  //! groups: sets of matrices, which have to be connected
+  void set_connected(const std::vector<Mask>& opmats, const std::vector<Mask>& matadj,
+                     const std::vector<Mask>& groups);
+  //! emit only one contraction for each set of contractions that are equivalent under the
+  //! permutations of SQops in perms (a group including the identity) together with its weight
+  //! (not for the generalized Wick's theorem)
+  void set_symmetry(const std::vector<Perm>& perms);
+  //! enumerate all full contractions and pass them to sink
+  //! (the contractions are reused for operator strings with the same layout if wickcache > 0)
+  void contract(const Sink& sink);
+private:
+  // recursive enumeration for the remaining SQops
+  void contract(Mask remaining);
+  // one step in the enumeration: contract op1 and op2 (or move op1 to the density matrix if op2 == dmstep)
+  struct Step {
+    unsigned char op1, op2, flip;
+    Mask remaining;
+  };
+  static const unsigned char dmstep = 0xFF;
+  // generate the memo entries (steps with at least one full contraction) for the remaining SQops
+  // returns false if the remaining SQops cannot be fully contracted
+  bool memoize(Mask remaining);
+  // enumeration using the memo table
+  void replay(Mask remaining);
+  // emit the current contraction to the sink
+  void emit();
+  // key for the cache: everything that determines the contractions
+  std::string layout() const;
+  // contractions of an operator string (SQop indices of all contractions in idx)
+  struct Contractions {
+    struct Entry {
+      unsigned char nkrons, ndm;
+      signed char sign;
+      uint weight;
+    };
+    std::vector<Entry> entries;
+    std::vector<unsigned char> idx;
+  };
+  typedef std::unordered_map< std::string, Contractions > Cache;
+  // number of equivalent contractions if the current one is the canonical one (otherwise 0)
+  uint canonical() const;
+  // can the current partial contraction still be completed to a canonical one?
+  bool canonicalizable(Mask remaining) const;
+  // can the remaining SQops still be fully contracted (counting quasi-particles per orbital type)?
+  bool feasible(Mask remaining) const;
+  // can the groups still be connected by contracting the remaining SQops?
+  bool connectable(Mask remaining) const;
+  // connect all matrices in mats
+  static void connect(Mask * adj, Mask mats);
+  // bit for SQop i
+  static Mask bit(uint i) { return Mask(1) << i; };
+  // number of SQops
+  uint _nops;
+  // generalized Wick's theorem
+  bool _genw;
+  // gender, PH-gender, orbital type and normal ordered group of each SQop
+  std::string _layout;
+  // SQops that can be contracted with SQop i (SQops right of i in other groups)
+  Mask _compat[maxops];
+  // quasi-creators (the contraction vanishes if they are leftmost)
+  Mask _qcreators;
+  // SQops which can go to density matrices
+  Mask _dmops;
+  // creators and annihilators for each orbital type
+  Mask _cre[Orbital::MaxType], _ann[Orbital::MaxType];
+  // quasi-creators and quasi-annihilators of all types except GenT and Act
+  Mask _qcfixed, _qafixed;
+  // matrices with the orbital of each SQop
+  Mask _opmats[maxops];
+  // matrices connected before contraction
+  std::vector<Mask> _matadj;
+  // sets of matrices which have to be connected
+  std::vector<Mask> _conngroups;
+  // memoize sub-contractions (generalized Wick's theorem)
+  bool _usememo;
+  std::unordered_map< Mask, std::vector<Step> > _memo;
+  // current Kronecker pairs
+  uint _krons[maxops];
+  uint _nkrons;
+  // current density-matrix SQops (filled from the end, i.e., _dm[_dmpos.._nops-1])
+  uint _dm[maxops];
+  uint _dmpos;
+  // current sign (0: +, 1: -)
+  uint _parity;
+  const Sink * _sink;
+  // symmetry group of the operator string
+  std::vector<Perm> _symperms;
+  // contractions for each layout (one cache per thread)
+  static thread_local Cache _cache;
+  // cache entry to which the emitted contractions are added (if not 0)
+  Contractions * _record;
+};
+
+#endif
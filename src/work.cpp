@@ -7,19 +7,36 @@ TermSum Q2::evalEq(Finput& finput)
   TermSum sum_finp(finput.sumterms());
   _xout2(" = " << sum_finp << std::endl);
   TermSum sum_NO;
-  if ( Input::iPars["prog"]["wick"] == 0 )
+  bool wick = ( Input::iPars["prog"]["wick"] > 0 );
+  // the first step of reduceSum (expansion of antisymmetrized integrals) can be done on the fly
+  bool expanded = ( wick && Input::config.noorder == 0 );
+  if ( !wick )
     sum_NO = Q2::normalOrderPH(sum_finp);
+  else if ( expanded )
+    Q2::wick(sum_finp,[&sum_NO](const Term& term, const TFactor& fac){ Q2::Antisymmetry(sum_NO,term,fac); });
   else
     sum_NO = Q2::wick(sum_finp);
   _xout2(" = " << sum_NO << std::endl);
-  TermSum sum_final1(Q2::reduceSum(sum_NO)),
+  TermSum sum_final1(Q2::reduceSum(std::move(sum_NO),expanded)),
     sum_final(Q2::postaction(sum_final1));
   _xout1(" = " << sum_final << std::endl);
   finput.sumterms(sum_final);
   return finput.sumterms();
 }
 
-TermSum Q2::reduceSum(TermSum s)
+void Q2::Antisymmetry(TermSum& sum, Term term, const TFactor& fac)
+{
+  if (! term.get_isinput()){
+    // expand antisymmetrized integrals
+    TermSum sum1 = term.expand_antisym();
+    sum1 *= fac;
+    sum += sum1;
+  }
+  else
+    sum += std::make_pair(term,fac);
+}
+
+TermSum Q2::reduceSum(TermSum s, bool expanded)
 {
   double minfac = Input::fPars["prog"]["minfac"];
   bool brill = ( Input::iPars["prog"]["brill"] > 0 );
@@ -28,14 +45,18 @@ TermSum Q2::reduceSum(TermSum s)
   bool explspin = Input::iPars["prog"]["explspin"];
   bool usefock = Input::iPars["prog"]["usefock"];
   usefock = usefock && (Input::iPars["prog"]["noorder"]>0);
+  assert( !expanded || !usefock );
   // 13.12.2016: temporary hack until a proper insert of intermediate tensors is implemented
   bool replaceE0 = Input::iPars["prog"]["replacee0"];
   replaceE0 = replaceE0 && (Input::iPars["prog"]["noorder"]>0);
   bool timing = ( Input::iPars["prog"]["cpu"] > 0 );
+  // all per-term steps in one pass
+  // (not with eqway>0: the diagrams and permutations there depend on the representatives the staged passes keep)
+  bool fused = ( Input::config.fused > 0 && Input::config.eqway == 0 );
+  if ( Input::config.fused > 0 && !fused ) say("No fused reduction with eqway>0");
   std::clock_t c_start=0;
   TermSum sum,sum1;
-  Term term,term1;
-  bool added;
+  Term term;
   TFactor prefac;
 
   if (usefock){
@@ -58,74 +79,108 @@ TermSum Q2::reduceSum(TermSum s)
   say("Reduce sum of terms");
   _xout3(s << std::endl);
 
-  say("Antisymmetry...");
-  if (timing) c_start = std::clock();
-  sum.clear();
-  for (TermSum::const_iterator i=s.begin();i!=s.end(); ++i) {
-    term=i->first;
-    if (! term.get_isinput()){
-      // expand antisymmetrized integrals
-      sum1 = term.expand_antisym();
-      sum1 *= i->second;
-      sum += sum1;
+  // connections of the matrices, false if the term is not properly connected
+  auto connectterm = [](Term& t){
+    // generate Kallay's "triplets of integers"
+    t.matrixkind();
+    // set connections "map" of matrices
+    t.setmatconnections();
+    // is the term properly connected?
+    return t.properconnect();
+  };
+  // diagrams and spin-integration, false if the term vanishes
+  auto diagterm = [brill,spinintegr](Term& t){
+    // use Brilloin condition
+    if ( brill && t.brilloin() ) return false;
+    // remove "None" matrices
+    t.deleteNoneMats();
+    t.setmatconnections();
+    t.spinintegration(spinintegr);
+    return true;
+  };
+  if ( fused ) {
+    say("Antisymmetry, Kroneckers, general indices, permutations, connections, diagrams...");
+    if (timing) c_start = std::clock();
+    // all per-term steps for each term, the terms are added to the sum only once
+    // the terms are not needed anymore after this step
+    for (TermSum::const_iterator i=s.begin();i!=s.end(); i=s.erase(i)) {
+      sum1.clear();
+      if ( expanded )
+        sum1 += *i;
+      else
+        Antisymmetry(sum1,i->first,i->second);
+      sum1 = ZeroTerms(GeneralIndices(Kroneckers(sum1)));
+      // bring all the density matrices into singlet-order
+      if (spinintegr || explspin) sum1 = SingletDM(sum1);
+      // important for permutations in input terms
+      sum1 = ResolvePermutations(sum1,true);
+      for ( TermSum::const_iterator j=sum1.begin();j!=sum1.end(); ++j) {
+        term=j->first;
+        if ( connectterm(term) && ( quan3 || diagterm(term) ) )
+          sum += std::make_pair(term,j->second);
+      }
+    }
+    _xout3(sum << std::endl);
+    if (timing) _CPUtiming("",c_start,std::clock());
+  } else {
+    if ( expanded )
+      sum.swap(s);
+    else {
+      say("Antisymmetry...");
+      if (timing) c_start = std::clock();
+      // the terms are not needed anymore after this step
+      for (TermSum::const_iterator i=s.begin();i!=s.end(); i=s.erase(i))
+        Antisymmetry(sum,i->first,i->second);
+      _xout3(sum << std::endl);
+      if (timing) _CPUtiming("",c_start,std::clock());
     }
-    else
-      sum += std::make_pair(term,i->second);
-  }
-  _xout3(sum << std::endl);
-  if (timing) _CPUtiming("",c_start,std::clock());
-
-  say("Kroneckers...");
-  if (timing) c_start = std::clock();
-  sum = Kroneckers(sum);
-  _xout3(sum << std::endl);
-  if (timing) _CPUtiming("",c_start,std::clock());
 
-  // set remaining general indices to the occupied or active space
-  say("Handle general indices...");
-  if (timing) c_start = std::clock();
-  sum = GeneralIndices(sum);
-  sum = ZeroTerms(sum);
-  _xout3(sum << std::endl);
-  if (timing) _CPUtiming("",c_start,std::clock());
+    say("Kroneckers...");
+    if (timing) c_start = std::clock();
+    sum = Kroneckers(sum);
+    _xout3(sum << std::endl);
+    if (timing) _CPUtiming("",c_start,std::clock());
 
-  if (spinintegr || explspin){
-    // bring all the density matrices into singlet-order
-    say("Singlet order...");
+    // set remaining general indices to the occupied or active space
+    say("Handle general indices...");
     if (timing) c_start = std::clock();
-    sum = SingletDM(sum);
+    sum = GeneralIndices(sum);
+    sum = ZeroTerms(sum);
     _xout3(sum << std::endl);
     if (timing) _CPUtiming("",c_start,std::clock());
-  }
 
-  // important for permutations in input terms
-  TermSum sum2;
-  sum2 = ResolvePermutations(sum,true);
-  sum.clear();
+    if (spinintegr || explspin){
+      // bring all the density matrices into singlet-order
+      say("Singlet order...");
+      if (timing) c_start = std::clock();
+      sum = SingletDM(sum);
+      _xout3(sum << std::endl);
+      if (timing) _CPUtiming("",c_start,std::clock());
+    }
 
-  say("Connections...");
-  if (timing) c_start = std::clock();
-  s = sum2;
-  sum2.clear();
-  for ( TermSum::const_iterator i=s.begin();i!=s.end(); ++i) {
-    term=i->first;
-    // generate Kallay's "triplets of integers"
-    term.matrixkind();
-    // set connections "map" of matrices
-    term.setmatconnections();
-    // is the term properly connected?
-    if (!term.properconnect()) {
-      continue;
+    // important for permutations in input terms
+    TermSum sum2;
+    sum2 = ResolvePermutations(sum,true);
+    sum.clear();
+
+    say("Connections...");
+    if (timing) c_start = std::clock();
+    s = sum2;
+    sum2.clear();
+    for ( TermSum::const_iterator i=s.begin();i!=s.end(); ++i) {
+      term=i->first;
+      if ( connectterm(term) )
+        sum += std::make_pair(term,i->second);
     }
-    sum += std::make_pair(term,i->second);
+    _xout3(sum << std::endl);
+    if (timing) _CPUtiming("",c_start,std::clock());
   }
-  _xout3(sum << std::endl);
-  if (timing) _CPUtiming("",c_start,std::clock());
   if (quan3) {
     say("count electrons (a posteriori)...");
     if (timing) c_start = std::clock();
     s = sum;
     sum.clear();
+    EqualIndex index;
     for ( TermSum::const_iterator i=s.begin();i!=s.end(); ++i) {
       term=i->first;
       term.deleteNoneMats();
@@ -134,42 +189,24 @@ TermSum Q2::reduceSum(TermSum s)
       prefac=i->second*term.prefac();
       // remove prefactors in terms
       term.reset_prefac();
-      added=false;
-      for ( TermSum::iterator k=sum.begin();k!=sum.end(); ++k) {
-        Permut perm;
-        term1=k->first;
-        if (term.equal(term1,perm)) {
-          sum.erase(k);
-          term1+=std::make_pair(perm,prefac);
-          if ( !term1.term_is_0(minfac) ) sum+=term1;
-          added=true;
-          break;
-        }
-      }
-      if (!added) {
-        term+=std::make_pair(Permut(),prefac);
-        if ( !term.term_is_0(minfac) ) sum+=term;
-      }
+      index.add(sum,term,prefac,minfac);
     }
     if (timing) _CPUtiming("",c_start,std::clock());
     return sum;
   }
-  say("Diagrams and Spin-integration...");
-  if (timing) c_start = std::clock();
-  s = sum;
-  sum.clear();
-  for ( TermSum::const_iterator i=s.begin();i!=s.end(); ++i) {
-    term=i->first;
-    // use Brilloin condition
-    if ( brill && term.brilloin() ) continue;
-    // remove "None" matrices
-    term.deleteNoneMats();
-    term.setmatconnections();
-    term.spinintegration(spinintegr);
-    sum += std::make_pair(term,i->second);
+  if ( !fused ) {
+    say("Diagrams and Spin-integration...");
+    if (timing) c_start = std::clock();
+    s = sum;
+    sum.clear();
+    for ( TermSum::const_iterator i=s.begin();i!=s.end(); ++i) {
+      term=i->first;
+      if ( diagterm(term) )
+        sum += std::make_pair(term,i->second);
+    }
+    _xout3(sum << std::endl);
+    if (timing) _CPUtiming("",c_start,std::clock());
   }
-  _xout3(sum << std::endl);
-  if (timing) _CPUtiming("",c_start,std::clock());
 
   say("Equal terms and permutations...");
   if (timing) c_start = std::clock();
@@ -320,10 +357,16 @@ TermSum Q2::ZeroTerms(const TermSum& s)
 TermSum Q2::EqualTerms(const TermSum& s, double minfac)
 {
   int eqway = Input::iPars["prog"]["eqway"];
+  unsigned int nthreads = Parallel::nthreads(Input::config.threads);
+  if ( eqway > 0 && nthreads > 1 && s.size() > 1 ) return EqualGraphs(s,minfac,nthreads);
   TermSum sum;
   BigArray<UniGraph> ugraphs;
   BigArray<Term> uterms, newterms;
-  Term term,term1;
+  // hash key of the minimized graph -> position in ugraphs
+  std::unordered_multimap<uint64_t,uint> ugindex;
+  // eqway == 0: terms in sum bucketed by their invariants
+  EqualIndex index;
+  Term term;
   TFactor prefac;
   bool added;
   for ( TermSum::const_iterator j=s.begin();j!=s.end(); ++j) {
@@ -341,23 +384,25 @@ TermSum Q2::EqualTerms(const TermSum& s, double minfac)
       UniGraph ug(uterm);
 //       xout << ug << std::endl;
       ug.minimize();
-      added=false;
-      for ( uint igr = 0; igr < ugraphs.size(); ++igr ){
-        if ( ug.is_equal(ugraphs[igr]) ) {
-//           if (print) xout << "before add " << newterms[igr] << std::endl;
-          newterms[igr] += ug.permutation(ugraphs[igr]);
-//           if (print) xout << "after add " << newterms[igr] << std::endl;
-          added=true;
-          break;
-        }
+      uint64_t key = ug.hashkey();
+      // the first equal graph (as in a linear search)
+      uint igr = ugraphs.size();
+      auto range = ugindex.equal_range(key);
+      for ( auto it = range.first; it != range.second; ++it ){
+        if ( it->second < igr && ug.is_equal(ugraphs[it->second]) ) igr = it->second;
       }
+      added = ( igr < ugraphs.size() );
       if (added) {
+//         if (print) xout << "before add " << newterms[igr] << std::endl;
+        newterms[igr] += ug.permutation(ugraphs[igr]);
+//         if (print) xout << "after add " << newterms[igr] << std::endl;
         // not needed anymore
         uterms.pop_back();
       } else {
         term = ug.gen_term();
 //         if (print) xout << term << std::endl;
         newterms.push_back(term);
+        ugindex.emplace(key,ugraphs.size());
         ugraphs.push_back(ug);
       }
     } else {
@@ -367,24 +412,7 @@ TermSum Q2::EqualTerms(const TermSum& s, double minfac)
           error("Use eqway>0 for tensors with plus/minus symmetry");
         }
       }
-      added=false;
-      for ( TermSum::iterator k=sum.begin();k!=sum.end(); ++k) {
-        Permut perm;
-        term1=k->first;
-        if (term.equal(term1,perm)) {
-          sum.erase(k);
-          term1+=std::make_pair(perm,prefac);
-//         std::cout<<"term old" << term1 <<std::endl;
-          if ( !term1.term_is_0(minfac) ) sum+=term1;
-          added=true;
-          break;
-        }
-      }
-      if (!added) {
-        term+=std::make_pair(Permut(),prefac);
-        if ( !term.term_is_0(minfac) ) sum+=term;
-//       std::cout<<"term new" << term <<std::endl;
-      }
+      index.add(sum,term,prefac,minfac);
     }
   }
   if (eqway > 0) {
@@ -400,6 +428,115 @@ TermSum Q2::EqualTerms(const TermSum& s, double minfac)
   return sum;
 } 
 
+TermSum Q2::EqualGraphs(const TermSum& s, double minfac, unsigned int nthreads)
+{
+  std::vector<Term> uterms;
+  uterms.reserve(s.size());
+  for ( TermSum::const_iterator j=s.begin();j!=s.end(); ++j) {
+    uterms.push_back(j->first);
+    Term & uterm = uterms.back();
+    if( uterm.perm().size() > 1 ) error("ResolvePermutations() before EqualTerms()");
+    TFactor prefac = j->second*uterm.prefac();
+    uterm.reset_prefac();
+    uterm.set_prefac(prefac);
+  }
+  // the graphs are independent
+  std::vector< std::unique_ptr<UniGraph> > ugraphs(uterms.size());
+  std::vector<uint64_t> keys(uterms.size());
+  Parallel::for_each(uterms.size(),nthreads,[&](std::size_t it){
+    ugraphs[it].reset(new UniGraph(uterms[it]));
+    ugraphs[it]->minimize();
+    keys[it] = ugraphs[it]->hashkey();
+  });
+  // equal graphs have the same key, i.e., they are in the same shard
+  // (the terms of a shard are handled in the original order as in EqualTerms)
+  std::size_t nshards = std::min<std::size_t>(4*nthreads,uterms.size());
+  std::vector< std::vector<uint> > shards(nshards);
+  for ( uint it = 0; it < uterms.size(); ++it )
+    shards[keys[it]%nshards].push_back(it);
+  // new terms of each shard with the position of the first graph
+  typedef std::vector< std::pair<uint,Term> > NewTerms;
+  std::vector<NewTerms> newterms(nshards);
+  Parallel::for_each(nshards,nthreads,[&](std::size_t is){
+    NewTerms& nterms = newterms[is];
+    // hash key -> position in nterms
+    std::unordered_multimap<uint64_t,uint> ugindex;
+    for ( uint it: shards[is] ) {
+      UniGraph& ug = *ugraphs[it];
+      // the first equal graph
+      uint igr = nterms.size();
+      auto range = ugindex.equal_range(keys[it]);
+      for ( auto ir = range.first; ir != range.second; ++ir ){
+        if ( ir->second < igr && ug.is_equal(*ugraphs[nterms[ir->second].first]) ) igr = ir->second;
+      }
+      if ( igr < nterms.size() ) {
+        nterms[igr].second += ug.permutation(*ugraphs[nterms[igr].first]);
+      } else {
+        ugindex.emplace(keys[it],nterms.size());
+        nterms.push_back(std::make_pair(it,ug.gen_term()));
+      }
+    }
+  });
+  // merge the shards in the order of the first graphs
+  std::vector< std::pair<uint,Term> * > order;
+  for ( NewTerms& nterms: newterms )
+    for ( auto& nterm: nterms )
+      order.push_back(&nterm);
+  std::sort(order.begin(),order.end(),[](const std::pair<uint,Term> * a, const std::pair<uint,Term> * b){
+    return a->first < b->first; });
+  TermSum sum;
+  for ( auto pnterm: order ) {
+    Term& newterm = pnterm->second;
+    if ( !newterm.term_is_0(minfac) ) {
+      // for sorting... Remove if too slow
+      newterm.matrixkind();
+      newterm.setmatconnections();
+      sum += newterm;
+    }
+  }
+  return sum;
+}
+
+void Q2::EqualIndex::insert(TermSum::iterator it, uint64_t key)
+{
+  _pos[&it->first] = std::make_pair(key,_buckets[key].insert(it));
+}
+
+void Q2::EqualIndex::erase(TermSum::iterator it)
+{
+  auto ipos = _pos.find(&it->first);
+  assert( ipos != _pos.end() );
+  _buckets[ipos->second.first].erase(ipos->second.second);
+  _pos.erase(ipos);
+}
+
+void Q2::EqualIndex::add(TermSum& sum, Term& term, const TFactor& prefac, double minfac)
+{
+  uint64_t key = term.equalkey();
+  // only terms with the same invariants can be equal
+  for ( TermSum::iterator k: _buckets[key] ) {
+    Permut perm;
+    _term1 = k->first;
+    if (term.equal(_term1,perm)) {
+      erase(k);
+      sum.erase(k);
+      _term1 += std::make_pair(perm,prefac);
+      if ( !_term1.term_is_0(minfac) ) {
+        auto ins = sum.try_emplace(_term1);
+        ins.first->second += 1;
+        if ( ins.second ) insert(ins.first,key);
+      }
+      return;
+    }
+  }
+  term += std::make_pair(Permut(),prefac);
+  if ( !term.term_is_0(minfac) ) {
+    auto ins = sum.try_emplace(term);
+    ins.first->second += 1;
+    if ( ins.second ) insert(ins.first,key);
+  }
+}
+
 TermSum Q2::SmallTerms(const TermSum& s, double minfac)
 {
   TermSum sum;
@@ -710,33 +847,66 @@ TermSum Q2::normalOrderPH(const TermSum& s)
   return sum;
 }
 TermSum Q2::wick(const TermSum& s)
+{
+  TermSum sum;
+  wick(s,[&sum](const Term& term, const TFactor& fac){ sum += std::make_pair(term,fac); });
+  return sum;
+}
+void Q2::wick(const TermSum& s, const TermSink& sink)
 {
   int iwick = Input::iPars["prog"]["wick"];
-  bool genwick = (iwick > 1);
+  bool genwick = (iwick == 2);
+  // only one of the contractions which are equivalent by symmetry (with weight)
+  bool symm = (iwick == 3);
   int noorder = Input::iPars["prog"]["noorder"];
   if (!genwick && noorder > 0 ) error("Cannot have non-ordered Hamiltonian with wick<2. Either set noorder=0 or wick=2");
+  bool connected = ( Input::config.connected > 0 );
   bool timing = ( Input::iPars["prog"]["cpu"] > 0 );
+  unsigned int nthreads = Parallel::nthreads(Input::config.threads);
   std::clock_t c_start=0;
-  TermSum sum,sum0;
-  Term term;
   _xout3(s << std::endl);
   say("Wick's theorem");
   if (timing) c_start = std::clock();
-  for (TermSum::const_iterator i=s.begin(); i!=s.end(); ++i){
-    term=i->first;
-    if(term.get_isinput()){
-      term.clear_opProd();
-      sum += std::make_pair(term,i->second);
+  std::vector<TermSum::const_iterator> terms;
+  for (TermSum::const_iterator i=s.begin(); i!=s.end(); ++i)
+    terms.push_back(i);
+  // the terms are independent: apply Wick's theorem in parallel to chunks of terms
+  // and pass the results of each chunk to the sink in the original order,
+  // i.e., only the contracted terms of one chunk are kept at a time
+  bool parallel = ( nthreads > 1 && terms.size() > 1 );
+  std::size_t nchunk = ( parallel ? 4*nthreads : terms.size() );
+  typedef std::vector< std::pair<Term,TFactor> > Contracted;
+  std::vector<Contracted> contracted;
+  for (std::size_t first = 0; first < terms.size(); first += nchunk){
+    std::size_t last = std::min(first+nchunk,terms.size());
+    if ( parallel ) {
+      contracted.assign(last-first,Contracted());
+      Parallel::for_each(last-first,nthreads,[&](std::size_t ic){
+        const Term& term = terms[first+ic]->first;
+        Contracted& contr = contracted[ic];
+        if(!term.get_isinput())
+          term.wickstheorem([&contr](const Term& t, const TFactor& fac){ contr.push_back(std::make_pair(t,fac)); },
+                            genwick,noorder,connected,symm);
+      });
     }
-    else{
-      sum0 += term.wickstheorem(genwick,noorder);
-      sum0 *= i->second;
-      sum += sum0;
-      sum0=TermSum();
+    for (std::size_t it = first; it < last; ++it){
+      const TFactor& fac = terms[it]->second;
+      if(terms[it]->first.get_isinput()){
+        Term term(terms[it]->first);
+        term.clear_opProd();
+        sink(term,fac);
+      } else if ( !parallel ) {
+        terms[it]->first.wickstheorem([&sink,&fac](const Term& t, const TFactor& f){ sink(t,f*fac); },
+                                      genwick,noorder,connected,symm);
+      } else {
+        for ( const auto& tf: contracted[it-first] )
+          sink(tf.first,tf.second*fac);
+        contracted[it-first] = Contracted();
+      }
     }
   }
+  if ( parallel ) releasememory();
   if (timing) _CPUtiming("",c_start,std::clock());
-  return sum;
 }
 
 void Q2::printdiags(Output* pout, const TermSum& s)
@@ -2,6 +2,9 @@
 #define Work_H
 
 #include <vector>
+#include <set>
+#include <unordered_map>
+#include <memory>
 #include <stdlib.h>
 #include <cmath>
 #include <algorithm>
@@ -18,13 +21,17 @@
 #include "unigraph.h"
 #include "finput.h"
 #include "factorizer.h"
+#include "parallel.h"
 #include <iostream>
 
 
 namespace Q2
 {
   TermSum evalEq(Finput& finput);
-  TermSum reduceSum(TermSum s);
+  //! expanded: the antisymmetrized integrals in s are already expanded (Q2::Antisymmetry)
+  TermSum reduceSum(TermSum s, bool expanded = false);
+  //! add term*fac to sum, with expanded antisymmetrized integrals
+  void Antisymmetry(TermSum& sum, Term term, const TFactor& fac);
   TermSum Kroneckers(const TermSum& s);
   TermSum SingletDM(TermSum s);
   bool has_nonsingldm(const TermSum& s);
@@ -34,6 +41,35 @@ namespace Q2
   bool has_generalindices(const TermSum& s);
   TermSum ZeroTerms(const TermSum& s);
   TermSum EqualTerms(const TermSum& s, double minfac);
+  //! EqualTerms for eqway > 0 using nthreads threads: the graphs are minimized in parallel and
+  //! compared in shards of equal hash keys, the result is the same as in the serial run
+  TermSum EqualGraphs(const TermSum& s, double minfac, unsigned int nthreads);
+  /*!
+      Terms of a TermSum bucketed by Term::equalkey(),
+      the terms in a bucket are kept in the order of the TermSum
+  */
+  class EqualIndex {
+  public:
+    //! add term*prefac to sum and combine it with the first equal term (Term::equal) in sum
+    void add(TermSum& sum, Term& term, const TFactor& prefac, double minfac);
+  private:
+    // order of the TermSum
+    struct SumOrder {
+      bool operator()(TermSum::iterator a, TermSum::iterator b) const
+        { return TermSum::key_compare()(a->first,b->first); };
+    };
+    // multiset: the artificial ordering of terms is not strict, different elements of sum may be equivalent
+    typedef std::multiset<TermSum::iterator,SumOrder> Bucket;
+    // add a new element of sum
+    void insert(TermSum::iterator it, uint64_t key);
+    // remove an element (before it is erased from sum)
+    void erase(TermSum::iterator it);
+    std::unordered_map< uint64_t, Bucket > _buckets;
+    // key and position in the bucket for each element
+    std::unordered_map< const Term *, std::pair<uint64_t,Bucket::iterator> > _pos;
+    // for comparisons
+    Term _term1;
+  };
   TermSum SmallTerms(const TermSum& s, double minfac);
   TermSum VirtSpace(const TermSum& s);
   void SpinExpansion(Finput& finput, TermSum sum_final, std::vector<TermSum>& sums_final);
@@ -41,6 +77,8 @@ namespace Q2
   TermSum ResolvePermutations(const TermSum& s, bool inputterms = false);
   TermSum normalOrderPH(const TermSum& s);
   TermSum wick(const TermSum& s);
+  // Wick's theorem, pass every contracted term to sink
+  void wick(const TermSum& s, const TermSink& sink);
   //!helps EqualTerms to find equal terms. Assumes full anti-symmetry of amplitudes!
   TermSum PreConditioner(const TermSum& s);
   TermSum postaction(const TermSum& s);